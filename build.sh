@@ -9,19 +9,33 @@ rm ./demo/microsat.wasm
 # clean release build
 mkdir -p release
 rm ./release/Wrapper.js
+rm ./release/PoolWorker.js
 
 cd ./src
 make clean
 
 # build
+EMCC_FLAGS="-O3 -s ALLOW_MEMORY_GROWTH=1 -s INVOKE_RUN=0 -s FORCE_FILESYSTEM=1 -s EXIT_RUNTIME=1 --pre-js ../src_js/prerun.js -s MODULARIZE=1 -s 'EXPORT_NAME=microsat' -s 'EXPORTED_FUNCTIONS=[\"_main\",\"_malloc\",\"_free\",\"_setInput\",\"_sessionCreate\",\"_sessionPropagate\",\"_sessionSolve\",\"_sessionBackbone\",\"_sessionFree\",\"_sessionLoad\",\"_sessionSnapshot\",\"_sessionSolveStart\",\"_sessionSolveStep\",\"_sessionSolveAbort\",\"_sessionProgress\",\"_heapEnd\"]' -s 'EXTRA_EXPORTED_RUNTIME_METHODS=[\"ccall\"]'"
+
 echo "\n### Building release build..."
-FILE_SUFFIX=".js" CFLAGS="-O3 -s ALLOW_MEMORY_GROWTH=1 -s INVOKE_RUN=0 -s FORCE_FILESYSTEM=1 -s EXIT_RUNTIME=1 --pre-js ../src_js/prerun.js -s MODULARIZE=1 -s 'EXPORT_NAME=microsat'" CC=emcc emconfigure ./configure && emmake make
+FILE_SUFFIX=".js" CFLAGS="$EMCC_FLAGS" CC=emcc emconfigure ./configure && emmake make
 
 cd ..
 cp ./src_js/Wrapper.js ./release/Wrapper.js
+cp ./src_js/PoolWorker.js ./release/PoolWorker.js
 cp ./src/microsat.js ./release/microsat.js
 cp ./src/microsat.wasm ./release/microsat.wasm
 
+# build with statistics (for Wrapper.runWithStats)
+echo "\n### Building release build with statistics..."
+cd ./src
+make clean
+FILE_SUFFIX=".js" CFLAGS="$EMCC_FLAGS" CC=emcc emconfigure ./configure -s && emmake make
+
+cd ..
+cp ./src/microsat.js ./release/microsat-stats.js
+cp ./src/microsat.wasm ./release/microsat-stats.wasm
+
 # optionally build and run demo web app
 if [ -n "$1" -a "$1" = "demo" ]
 then
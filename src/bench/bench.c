@@ -0,0 +1,67 @@
+// Benchmark of microsat on one formula (one run per formula, so the peak RSS belongs to it):
+//
+//   bench [--queries Q] [--preprocess] DIMACS_FILE
+//
+// Prints a single JSON line with the parse and solve time, the conflicts and propagations
+// per second, the peak RSS, and the latency of Q --propagate queries on a session. The
+// assumptions of a query are 10 random literals of the model found by solve. With --preprocess
+// the formula is simplified first (included in the parse time), and so are the sessions.
+
+#define NO_MAIN
+#include "../microsat.c"
+#include <time.h>
+#include <sys/resource.h>
+
+double now () {                                                      // Monotonic time in seconds
+  struct timespec t; clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec; }
+
+int compare (const void* a, const void* b) {                         // Sort latencies in increasing order
+  double x = *(const double*) a, y = *(const double*) b;
+  return (x > y) - (x < y); }
+
+double rate (double count, double time) { return (time > 0) ? count / time : 0; }
+
+int main (int argc, char** argv) {
+  int nQueries = 100, simplify = SIMPLIFY_NONE, i, j;
+  if (argc > 2 && !strcmp (argv[1], "--queries")) nQueries = atoi (argv[2]), argv += 2, argc -= 2;
+  if (argc > 1 && !strcmp (argv[1], "--preprocess")) simplify = SIMPLIFY_ALL, argv++, argc--;
+  if (argc != 2 || nQueries < 0) printf ("Usage: bench [--queries Q] [--preprocess] DIMACS_FILE\n"), exit (ERROR);
+  size_t length; const char* data = mapFile (argv[1], &length);
+  if (data == NULL) exit (ERROR);
+
+  struct solver S; double start = now ();
+  int result = parseBuffer (&S, data, length, simplify);             // Parse from memory, as the CLI does
+  double parseTime = now () - start;
+  if (result == ERROR) exit (ERROR);
+  S.nAssignments = 0; start = now ();
+  if (result == SAT) result = solve (&S);
+  double solveTime = now () - start;
+  if (result == ERROR) exit (ERROR);
+  struct rusage usage; getrusage (RUSAGE_SELF, &usage);              // Before the session allocates a second solver
+
+  struct solver* session = (result == SAT) ? sessionCreate (data, length, simplify) : NULL;
+  int *lits = allocate (10), nLits = (S.nVars < 10) ? S.nVars : 10;
+  double *latency = (double*) malloc (sizeof (double) * (nQueries + 1)), total = 0;
+  if (!session || !lits || !latency) nQueries = 0;                   // No queries for UNSAT formulas
+  unsigned seed = 1; fflush (stdout);
+  int out = dup (1), null = open ("/dev/null", O_WRONLY); dup2 (null, 1); // Hide the output of the queries
+  for (i = 0; i < nQueries; i++) {
+    for (j = 0; j < nLits; j++) {                                    // Random literals of the model (consistent)
+      seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+      int var = 1 + seed % S.nVars; lits[j] = S.model[var] ? var : -var; }
+    start = now (); sessionPropagate (session, lits, nLits); fflush (stdout);
+    total += latency[i] = now () - start; }
+  dup2 (out, 1); close (null); close (out);
+  qsort (latency, nQueries, sizeof (double), compare);
+
+  printf ("{\"file\": \"%s\", \"vars\": %i, \"clauses\": %i, \"result\": \"%s\", "
+          "\"parse_s\": %.6f, \"solve_s\": %.6f, \"conflicts\": %i, \"propagations\": %lld, "
+          "\"conflicts_per_s\": %.0f, \"propagations_per_s\": %.0f, \"peak_rss_kb\": %ld, "
+          "\"queries\": %i, \"propagate_us_mean\": %.1f, \"propagate_us_p50\": %.1f, \"propagate_us_p99\": %.1f}\n",
+          argv[1], S.nVars, S.nClauses, (result == SAT) ? "SAT" : "UNSAT",
+          parseTime, solveTime, S.nConflicts, S.nPropagations,
+          rate (S.nConflicts, solveTime), rate (S.nPropagations, solveTime), usage.ru_maxrss, nQueries,
+          nQueries ? 1e6 * total / nQueries : 0, nQueries ? 1e6 * latency[nQueries / 2] : 0,
+          nQueries ? 1e6 * latency[(99 * nQueries) / 100] : 0);
+  return 0; }
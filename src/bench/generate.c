@@ -0,0 +1,72 @@
+// Generator of the benchmark formulas (DIMACS on standard output):
+//
+//   generate fm VARS [SEED]            feature-model-like formula with VARS features
+//   generate 3sat VARS [SEED [RATIO]]  random 3-SAT with RATIO * VARS clauses (default 4.26)
+//
+// The feature models are trees: every feature implies its parent, and the children of a
+// feature are mandatory, optional, an or-group or an alternative-group. About VARS / 10
+// cross-tree constraints (requires and excludes) are added on top.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned seed;                                                       // State of the random number generator
+
+unsigned randomInt (unsigned n) {                                    // A random number in 0 .. n-1 (xorshift)
+  seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+  return seed % n; }
+
+int *clauses, nClauses, size, capacity;                              // All clauses, each terminated by 0
+
+void add (int lit) {                                                 // Add a literal (0 ends the clause)
+  if (size == capacity) {
+    capacity = capacity ? 2 * capacity : 1 << 16;
+    clauses = realloc (clauses, sizeof (int) * capacity);
+    if (clauses == NULL) printf ("c OUT OF MEMORY\n"), exit (1); }
+  clauses[size++] = lit; if (!lit) nClauses++; }
+
+void binary (int a, int b) { add (a); add (b); add (0); }
+
+void featureModel (int n) {                                          // The features are numbered in breadth-first order
+  int parent, next = 2, i, j;
+  add (1); add (0);                                                  // The root feature is always selected
+  for (parent = 1; next <= n; parent++) {                            // Every feature gets 1 to 6 children
+    int first = next, last = next + randomInt (6), type = randomInt (10);
+    if (last > n) last = n;
+    next = last + 1;
+    for (i = first; i <= last; i++) binary (-i, parent);             // A child implies its parent
+    if (type < 3)                                                    // Mandatory children: the parent implies them
+      for (i = first; i <= last; i++) binary (-parent, i);
+    else if (type < 5) {                                             // Or-group: at least one child
+      add (-parent); for (i = first; i <= last; i++) add (i); add (0); }
+    else if (type < 7 && last - first < 5) {                         // Alternative-group: exactly one child
+      add (-parent); for (i = first; i <= last; i++) add (i); add (0);
+      for (i = first; i <= last; i++)
+        for (j = i + 1; j <= last; j++) binary (-i, -j); } }         // Otherwise all children are optional
+  for (i = 0; i < n / 10; i++) {                                     // Cross-tree constraints between random features
+    int a = 2 + randomInt (n - 1), b = 2 + randomInt (n - 1);
+    if (a == b) continue;
+    if (randomInt (4)) binary (-a, b);                               // a requires b
+    else binary (-a, -b); } }                                        // a excludes b
+
+void random3SAT (int n, double ratio) {                              // Three different variables per clause
+  int m = (int) (ratio * n), i;
+  for (i = 0; i < m; i++) {
+    int a = 1 + randomInt (n), b, c;
+    do b = 1 + randomInt (n); while (b == a);
+    do c = 1 + randomInt (n); while (c == a || c == b);
+    add (randomInt (2) ? a : -a); add (randomInt (2) ? b : -b); add (randomInt (2) ? c : -c); add (0); } }
+
+int main (int argc, char** argv) {
+  if (argc < 3) printf ("Usage: generate fm VARS [SEED] | 3sat VARS [SEED [RATIO]]\n"), exit (1);
+  int n = atoi (argv[2]), i;
+  unsigned start = (argc > 3) ? (unsigned) atoi (argv[3]) : 1; seed = start ? start : 1;
+  if (n < 3) printf ("c VARS must be at least 3\n"), exit (1);
+  if (!strcmp (argv[1], "fm")) featureModel (n);
+  else if (!strcmp (argv[1], "3sat")) random3SAT (n, (argc > 4) ? atof (argv[4]) : 4.26);
+  else printf ("c UNKNOWN KIND %s\n", argv[1]), exit (1);
+  printf ("c generated by: generate %s %i %u\np cnf %i %i\n", argv[1], n, start, n, nClauses);
+  for (i = 0; i < size; i++)
+    if (clauses[i]) printf ("%i ", clauses[i]); else printf ("0\n");
+  return 0; }
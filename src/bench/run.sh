@@ -0,0 +1,35 @@
+#!/bin/sh
+# Run the benchmarks (make bench): prints one JSON line per formula, see bench.c.
+# The formulas are generated once into bench/cnf. The sizes can be changed, e.g.
+#   FM_SIZES="1000 10000" SAT_SIZES="150" SEEDS="1" QUERIES=20 make bench
+# and PREPROCESS=1 simplifies the formulas first (bench --preprocess).
+
+cd "$(dirname "$0")"
+FM_SIZES=${FM_SIZES:-"1000 10000 100000 1000000"}
+SAT_SIZES=${SAT_SIZES:-"100 150 175"}
+SEEDS=${SEEDS:-"1 2"}
+QUERIES=${QUERIES:-100}
+
+mkdir -p cnf
+for f in ../test/buildable.cnf ../test/incomplete.cnf
+do
+	./bench --queries $QUERIES ${PREPROCESS:+--preprocess} $f || exit 1
+done
+for n in $FM_SIZES
+do
+	for seed in $SEEDS
+	do
+		f=cnf/fm_${n}_$seed.cnf
+		[ -f $f ] || ./generate fm $n $seed > $f
+		./bench --queries $QUERIES ${PREPROCESS:+--preprocess} $f || exit 1
+	done
+done
+for n in $SAT_SIZES
+do
+	for seed in $SEEDS
+	do
+		f=cnf/3sat_${n}_$seed.cnf
+		[ -f $f ] || ./generate 3sat $n $seed > $f
+		./bench --queries $QUERIES ${PREPROCESS:+--preprocess} $f || exit 1
+	done
+done
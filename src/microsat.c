@@ -1,17 +1,66 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
 
-enum EXIT_CODES { OK = 0, ERROR = 1, SAT = 10, UNSAT = 20, BUILDABLE = 30, INCOMPLETE = 40 };
-enum LITERAL_MARKS { END = -9, MARK = 2, IMPLIED = 6 };
-enum MODES { MODE_SOLVE = 0, MODE_PROPAGATE = 1 };
+enum EXIT_CODES { OK = 0, UNKNOWN = 0, ERROR = 1, SAT = 10, UNSAT = 20, BUILDABLE = 30, INCOMPLETE = 40 };
+enum LITERAL_MARKS { MARK = 2, IMPLIED = 6 };
+enum MODES { MODE_SOLVE = 0, MODE_PROPAGATE = 1, MODE_BACKBONE = 2 };
+enum SHARING { SHARE_SIZE = 8, SHARE_LBD = 2, SHARE_SLOTS = 4096, SHARE_INTERVAL = 1000 }; // Shared lemmas, and conflicts between imports
+enum SIMPLIFY { SIMPLIFY_NONE = 0, SIMPLIFY_EQUIVALENT = 1, SIMPLIFY_ALL = 2 }; // Preprocessing: none, keep the solutions, or also BVE
+enum SIMPLIFY_LIMITS { SUBSTITUTE_ROUNDS = 3, SUBSUME_BUDGET = 100000000, ELIMINATE_BUDGET = 100000000, // Literals visited
+                       ELIMINATE_PAIRS = 400, ELIMINATE_SIZE = 16 };  // At most 400 resolvents of at most 16 literals per variable
+enum PROGRESS { PROGRESS_CONFLICTS = 0, PROGRESS_PROPAGATIONS = 1, PROGRESS_LEMMAS = 2, PROGRESS_FIXED = 3 }; // See sessionProgress
+enum SNAPSHOT { SNAPSHOT_MAGIC = 0x5441534d, SNAPSHOT_VERSION = 1 }; // "MSAT" in a little-endian file, bumped on every change
 
-const int MEM_MAX = 1 << 28;
-int MODE = MODE_SOLVE;
+#ifdef STATS                                                       // Statistics are compiled in with configure -s
+#include <time.h>
+#define STAT(code) code
+enum PHASES { PHASE_PARSE, PHASE_SEARCH, PHASE_PROPAGATE, PHASE_ANALYZE, PHASE_MINIMIZE, PHASE_REDUCE, N_PHASES, STATS_LBD = 16 };
+struct stats { long long decisions, restarts, reductions, lbd[STATS_LBD + 1], // Counters, and a histogram of the LBD of lemmas
+  substituted, eliminated, subsumed, strengthened,                 // What the preprocessing removed
+  imported, dropped;                                               // Lemmas of a portfolio: added, or lost (overwritten)
+  int timing, phase, maxMemUsed; double start, time[N_PHASES]; };  // Timers (only with --stats) and the peak size of the DB
+#else
+#define STAT(code)                                                 // Without STATS the statistics cost nothing
+#endif
+
+const int MEM_MAX = 1 << 30;                                       // Upper bound on the size of the clause database
+const char* INPUT = NULL; size_t INPUT_SIZE = 0;                   // DIMACS text in memory, used if no file is given
+
+struct watchList { int size, capacity, *data; };                  // Pairs of a literal and the offset of a clause in the DB
+                                                                   // (a negative capacity means data is part of S->watchStore)
+
+struct slot { atomic_uint seq; atomic_int lits[SHARE_SIZE + 1]; }; // A shared lemma (0 terminated), seq is odd while it is written
+struct exchange { atomic_int result; int nSolvers; atomic_uint *nExported; struct slot *slots; }; // Shared by a portfolio
+
+struct snapshot { int magic, version, length, status, nVars, nClauses, mem_used, mem_fixed, nLemmas, maxLemmas, head, fast, slow,
+                  nAssigned, nProcessed, nForced, nWatches, nAssignments, nDead, nRepr, nEliminated; }; // The header (length in ints)
 
 struct solver { // The variables in the struct are described in the allocate procedure
-  int  *DB, nVars, nClauses, mem_used, mem_fixed, maxLemmas, nLemmas, *buffer, nConflicts, *model, *reason, *falseStack,
-       *false, *first, *forced, *processed, *assigned, *next, *prev, head, res, fast, slow, nAssignments, *assignments; };
+  int  *DB, nVars, nClauses, mem_used, mem_fixed, mem_size, maxLemmas, nLemmas, *buffer, nConflicts, *model, *reason, *falseStack,
+       *false, *forced, *processed, *assigned, *next, *prev, head, decision, res, fast, slow, nAssignments, *assignments, nDead, *dead, status;
+  struct watchList *watches, *implications; int *watchStore, margin, id, *nImported, nextImport; struct exchange* exchange;
+  long long nPropagations; int *repr; struct watchList eliminated; STAT (struct stats stats;) };
+
+#ifdef STATS
+double seconds () {                                                // Monotonic time in seconds
+  struct timespec t; clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec; }
+
+int enterPhase (struct solver* S, int phase) {                     // Charge the time since the last switch to the old phase
+  int old = S->stats.phase; S->stats.phase = phase;                // Returns the old phase, so it can be restored
+  if (S->stats.timing) { double now = seconds ();
+    S->stats.time[old] += now - S->stats.start; S->stats.start = now; }
+  return old; }
+#endif
 
 void unassign (struct solver* S, int lit) { S->false[lit] = 0; }   // Unassign the literal
 
@@ -19,48 +68,123 @@ void restart (struct solver* S) {                                  // Perform a
   while (S->assigned > S->forced) unassign (S, *(--S->assigned));  // Remove all unforced false lits from falseStack
   S->processed = S->forced; }                                      // Reset the processed pointer
 
-void assign (struct solver* S, int* reason, int forced) {          // Make the first literal of the reason true
-  int lit = reason[0];                                             // Let lit be the first literal in the reason
+void backtrack (struct solver* S, int* root) {                     // Undo all assignments above root (e.g. of a query)
+  while (S->assigned > root) unassign (S, *(--S->assigned));       // Remove all false lits above root from falseStack
+  S->processed = S->forced = root; }                               // Reset the processed and forced pointers
+
+void imply (struct solver* S, int lit, int reason, int forced) {   // Make lit true, reason is 1 + the offset of a clause
   S->false[-lit] = forced ? IMPLIED : 1;                           // Mark lit as true and IMPLIED if forced
   *(S->assigned++) = -lit;                                         // Push it on the assignment stack
-  S->reason[abs (lit)] = 1 + (int) ((reason)-S->DB);               // Set the reason clause of lit
+  S->reason[abs (lit)] = reason;                                   // Set the reason clause of lit
   S->model [abs (lit)] = (lit > 0); }                              // Mark the literal as true in the model
 
-void addWatch (struct solver* S, int lit, int mem) {               // Add a watch pointer to a clause containing lit
-  S->DB[mem] = S->first[lit]; S->first[lit] = mem; }               // By updating the database and the pointers
+void assign (struct solver* S, int* reason, int forced) {          // Make the first literal of the reason true
+  imply (S, reason[0], 1 + (int) ((reason)-S->DB), forced); }      // The reason clause starts with lit
+
+int reserve (struct watchList* list, int count) {                  // Make room for count more values in a list
+  if (list->size + count > abs (list->capacity)) {                 // Grow the list geometrically if it is full
+    int capacity = list->capacity ? 2 * abs (list->capacity) : 8;  // (which always makes room for a pair)
+    int* data = (int*) realloc (list->capacity < 0 ? NULL : list->data, sizeof (int) * capacity);
+    if (data == NULL) { printf ("c OUT OF MEMORY\n"); return ERROR; }
+    if (list->capacity < 0) memcpy (data, list->data, sizeof (int) * list->size); // Move out of the watch store
+    list->data = data; list->capacity = capacity; }
+  return OK; }
+
+int push (struct watchList* list, int value) {                     // Append a value to a list
+  if (reserve (list, 1) == ERROR) return ERROR;
+  list->data[list->size++] = value; return OK; }
+
+void addWatch (struct solver* S, struct watchList* list, int lit, int mem) { // Add the pair (lit, mem) to the list
+  if (reserve (list, 2) == ERROR) { S->status = ERROR; return; }   // The solver can not be used anymore
+  list->data[list->size++] = lit; list->data[list->size++] = mem; }
+
+void removeLemmas (struct watchList* list, int mem_fixed) {        // Remove the pairs that point to a lemma
+  int i, j = 0; for (i = 0; i < list->size; i += 2)
+    if (list->data[i+1] < mem_fixed) {                             // Keep the watches of input clauses
+      list->data[j++] = list->data[i]; list->data[j++] = list->data[i+1]; }
+  list->size = j; }
+
+int* allocate (int size) {                                         // Allocate size zero-initialized integers
+  int* store = (int*) calloc (size, sizeof (int));                 // For the arrays that are not part of the DB
+  if (store == NULL) printf ("c OUT OF MEMORY\n");                 // The caller has to check for NULL
+  return store; }
+
+int resizeDB (struct solver* S, int size) {                        // Set the capacity of the database to size
+  int* DB = (int*) realloc (S->DB, sizeof (int) * size);           // Pointers into the DB become invalid, offsets do not
+  if (DB == NULL) { printf ("c OUT OF MEMORY\n"); return S->status = ERROR; }
+  S->DB = DB; S->mem_size = size; return OK; }
 
 int* getMemory (struct solver* S, int mem_size) {                  // Allocate memory of size mem_size
-  if (S->mem_used + mem_size > MEM_MAX) {                          // In case the code is used within a code base
-    printf ("c OUT OF MEMORY\n"); exit (ERROR); }
+  if (S->mem_used + mem_size > S->mem_size) {                      // Grow the database geometrically if it is full
+    if (S->mem_used + mem_size > MEM_MAX) {                        // In case the code is used within a code base
+      printf ("c OUT OF MEMORY\n"); S->status = ERROR; return NULL; }
+    int size = S->mem_size;
+    while (size < S->mem_used + mem_size) size = (size < MEM_MAX / 2) ? 2 * size : MEM_MAX;
+    if (resizeDB (S, size) == ERROR) return NULL; }
   int *store = (S->DB + S->mem_used);                              // Compute a pointer to the new memory location
   S->mem_used += mem_size;                                         // Update the size of the used memory
+  STAT (if (S->mem_used > S->stats.maxMemUsed) S->stats.maxMemUsed = S->mem_used;)
   return store; }                                                  // Return the pointer
 
-int* addClause (struct solver* S, int* in, int size, int irr) {    // Adds a clause stored in *in of size size
-  int i, used = S->mem_used;                                       // Store a pointer to the beginning of the clause
-  int* clause = getMemory (S, size + 3) + 2;                       // Allocate memory for the clause in the database
-  if (size >  1) { addWatch (S, in[0], used  );                    // If the clause is not unit, then add
-                   addWatch (S, in[1], used+1); }                  // Two watch pointers to the datastructure
+int* storeClause (struct solver* S, int* in, int size) {           // Copy the clause to the database (without watches)
+  int i, *clause = getMemory (S, size + 1);                        // Allocate memory for the clause in the database
+  if (clause == NULL) return NULL;                                 // The DB is full
   for (i = 0; i < size; i++) clause[i] = in[i]; clause[i] = 0;     // Copy the clause from the buffer to the database
+  return clause; }
+
+void watchClause (struct solver* S, int* clause, int size, int mem) { // Add the watches of a clause starting at mem
+  if (size == 2) { addWatch (S, &S->implications[clause[0]], clause[1], mem); // Binary clauses are kept in implication lists:
+                   addWatch (S, &S->implications[clause[1]], clause[0], mem); } // falsifying one literal implies the other
+  if (size >  2) { addWatch (S, &S->watches[clause[0]], clause[1], mem); // Longer clauses watch their first two literals,
+                   addWatch (S, &S->watches[clause[1]], clause[0], mem); } } // the other watched literal is the first blocker
+
+int attachClauses (struct solver* S) {                            // Add the watches of all clauses in the DB at once
+  int i, head, offset = 0;                                         // Every list gets a slice of one block of memory
+  for (i = 0; i < S->mem_used; i++) {                              // Count the watches of each literal
+    for (head = i; S->DB[i]; i++);
+    if (i - head == 2) S->implications[S->DB[head]].capacity -= 2, S->implications[S->DB[head+1]].capacity -= 2;
+    if (i - head >  2) S->watches     [S->DB[head]].capacity -= 2, S->watches     [S->DB[head+1]].capacity -= 2; }
+  for (i = -S->nVars; i <= S->nVars; i++) offset -= S->watches[i].capacity + S->implications[i].capacity;
+  S->watchStore = (int*) malloc (sizeof (int) * (offset + 1)); offset = 0;
+  if (S->watchStore == NULL) { printf ("c OUT OF MEMORY\n"); return ERROR; }
+  for (i = -S->nVars; i <= S->nVars; i++) {                        // Point the lists into the store
+    if (S->watches[i].capacity) S->watches[i].data = S->watchStore + offset, offset -= S->watches[i].capacity;
+    if (S->implications[i].capacity) S->implications[i].data = S->watchStore + offset, offset -= S->implications[i].capacity; }
+  for (i = 0; i < S->mem_used; i++) {                              // Fill the lists (they have the exact capacity)
+    for (head = i; S->DB[i]; i++);
+    if (i - head < 2) continue;
+    struct watchList *list = (i - head == 2) ? S->implications : S->watches;
+    int a = S->DB[head], b = S->DB[head+1];
+    list[a].data[list[a].size++] = b; list[a].data[list[a].size++] = head;
+    list[b].data[list[b].size++] = a; list[b].data[list[b].size++] = head; }
+  return OK; }
+
+int* addClause (struct solver* S, int* in, int size, int irr) {    // Adds a clause stored in *in of size size
+  int used = S->mem_used;                                          // Store a pointer to the beginning of the clause
+  int* clause = storeClause (S, in, size);                         // Copy the clause to the database
+  if (clause == NULL) return NULL;                                 // The DB is full
+  watchClause (S, clause, size, used);                             // And watch it
   if (irr) S->mem_fixed = S->mem_used; else S->nLemmas++;          // Update the statistics
   return clause; }                                                 // Return the pointer to the clause is the database
 
 void reduceDB (struct solver* S, int k) {                     // Removes "less useful" lemmas from DB
+  STAT (int phase = enterPhase (S, PHASE_REDUCE); S->stats.reductions++;)
   while (S->nLemmas > S->maxLemmas) S->maxLemmas += 300;      // Allow more lemmas in the future
   S->nLemmas = 0;                                             // Reset the number of lemmas
 
-  int i; for (i = -S->nVars; i <= S->nVars; i++) {            // Loop over the variables
-    if (i == 0) continue; int* watch = &S->first[i];          // Get the pointer to the first watched clause
-    while (*watch != END)                                     // As long as there are watched clauses
-      if (*watch < S->mem_fixed) watch = (S->DB + *watch);    // Remove the watch if it points to a lemma
-      else                      *watch =  S->DB[  *watch]; }  // Otherwise (meaning an input clause) go to next watch
+  int i; for (i = -S->nVars; i <= S->nVars; i++) {            // Loop over the literals
+    if (i == 0) continue;                                     // Remove the watches that point to lemmas
+    removeLemmas (&S->watches[i], S->mem_fixed); removeLemmas (&S->implications[i], S->mem_fixed); }
 
   int old_used = S->mem_used; S->mem_used = S->mem_fixed;     // Virtually remove all lemmas
-  for (i = S->mem_fixed + 2; i < old_used; i += 3) {          // While the old memory contains lemmas
+  for (i = S->mem_fixed; i < old_used; i++) {                 // While the old memory contains lemmas
     int count = 0, head = i;                                  // Get the lemma to which the head is pointing
     while (S->DB[i]) { int lit = S->DB[i++];                  // Count the number of literals
       if ((lit > 0) == S->model[abs (lit)]) count++; }        // That are satisfied by the current model
-    if (count < k) addClause (S, S->DB+head, i-head, 0); } }  // If the latter is smaller than k, add it back
+    if (count < k) addClause (S, S->DB+head, i-head, 0); }    // If the latter is smaller than k, add it back
+  if (S->mem_used < S->mem_size / 4 && S->mem_size / 2 >= S->mem_fixed + 1024)
+    resizeDB (S, S->mem_size / 2);                            // Give memory back if the lemmas shrunk a lot
+  STAT (enterPhase (S, phase);) }
 
 void bump (struct solver* S, int lit) {                       // Move the variable to the front of the decision list
   if (S->false[lit] != IMPLIED) { S->false[lit] = MARK;       // MARK the literal as involved if not a top-level unit
@@ -74,11 +198,49 @@ int implied (struct solver* S, int lit) {                  // Check if lit(eral)
   if (S->false[lit] > MARK) return (S->false[lit] & MARK); // If checked before return old result
   if (!S->reason[abs (lit)]) return 0;                     // In case lit is a decision, it is not implied
   int* p = (S->DB + S->reason[abs (lit)] - 1);             // Get the reason of lit(eral)
-  while (*(++p))                                           // While there are literals in the reason
+  for (; *p; p++) if (*p != -lit)                          // Loop over the other literals in the reason
     if ((S->false[*p] ^ MARK) && !implied (S, *p)) {       // Recursively check if non-MARK literals are implied
       S->false[lit] = IMPLIED - 1; return 0; }             // Mark and return not implied (denoted by IMPLIED - 1)
   S->false[lit] = IMPLIED; return 1; }                     // Mark and return that the literal is implied
 
+void exportClause (struct solver* S, int* lits, int size) {    // Publish a lemma for the other solvers of the portfolio
+  struct exchange* X = S->exchange;                             // Every solver writes to its own ring of slots
+  unsigned n = atomic_load_explicit (&X->nExported[S->id], memory_order_relaxed);
+  struct slot* slot = &X->slots[S->id * SHARE_SLOTS + n % SHARE_SLOTS];
+  atomic_store_explicit (&slot->seq, 2 * n + 1, memory_order_relaxed); // Readers ignore the slot while it is written
+  atomic_thread_fence (memory_order_release);
+  int i; for (i = 0; i <= size; i++) atomic_store_explicit (&slot->lits[i], lits[i], memory_order_relaxed);
+  atomic_store_explicit (&slot->seq, 2 * n + 2, memory_order_release);
+  atomic_store_explicit (&X->nExported[S->id], n + 1, memory_order_release); }
+
+int importClauses (struct solver* S) {                          // Add the lemmas of the other solvers (at the root level)
+  struct exchange* X = S->exchange; int i, j, lits[SHARE_SIZE + 1];
+  for (j = 0; j < X->nSolvers; j++) { if (j == S->id) continue;
+    unsigned n = atomic_load_explicit (&X->nExported[j], memory_order_acquire), k = S->nImported[j];
+    if (n - k > SHARE_SLOTS) {                                  // Skip the lemmas that are overwritten already
+      STAT (S->stats.dropped += n - k - SHARE_SLOTS;) k = n - SHARE_SLOTS; }
+    for (; k != n; k++) {
+      struct slot* slot = &X->slots[j * SHARE_SLOTS + k % SHARE_SLOTS];
+      unsigned seq = atomic_load_explicit (&slot->seq, memory_order_acquire);
+      for (i = 0; i <= SHARE_SIZE; i++)                         // Copy the lemma, then check that it was not changed
+        if (!(lits[i] = atomic_load_explicit (&slot->lits[i], memory_order_relaxed))) break;
+      atomic_thread_fence (memory_order_acquire);
+      if (seq != 2 * k + 2 || atomic_load_explicit (&slot->seq, memory_order_relaxed) != seq) {
+        STAT (S->stats.dropped++;) continue; }                  // Overwritten while it was copied
+      int size = 0;
+      for (i = 0; lits[i]; i++)
+        if (S->false[-lits[i]]) break;                          // Satisfied at the root level, so it is not needed
+        else if (!S->false[lits[i]]) S->buffer[size++] = lits[i]; // Remove the literals that are false at the root level
+      if (lits[i]) continue;
+      STAT (S->stats.imported++;)
+      if (size == 0) return UNSAT;                              // All literals are false, so the formula is UNSAT
+      int* clause = addClause (S, S->buffer, size, 0);
+      if (clause == NULL) return ERROR;
+      if (size == 1) assign (S, clause, 1); }                   // Assign units right away (forced = 1)
+    S->nImported[j] = n; }
+  S->nextImport = S->nConflicts + SHARE_INTERVAL;
+  return SAT; }
+
 int* analyze (struct solver* S, int* clause) {         // Compute a resolvent from falsified clause
   S->res++; S->nConflicts++;                           // Bump restarts and update the statistic
   while (*clause) bump (S, *(clause++));               // MARK all literals in the falsified clause
@@ -87,11 +249,13 @@ int* analyze (struct solver* S, int* clause) {         // Compute a resolvent fr
       int *check = S->assigned;                        // Pointer to check if first-UIP is reached
       while (S->false[*(--check)] != MARK)             // Check for a MARK literal before decision
         if (!S->reason[abs(*check)]) goto build;       // Otherwise it is the first-UIP so break
-      clause = S->DB + S->reason[abs (*S->assigned)];  // Get the reason and ignore first literal
-      while (*clause) bump (S, *(clause++)); }         // MARK all literals in reason
+      clause = S->DB + S->reason[abs (*S->assigned)] - 1; // Get the reason (it contains the true literal)
+      for (; *clause; clause++)                        // MARK all other literals in reason
+        if (*clause != -*S->assigned) bump (S, *clause); }
     unassign (S, *S->assigned); }                      // Unassign the tail of the stack
 
   build:; int size = 0, lbd = 0, flag = 0;             // Build conflict clause; Empty the clause buffer
+  STAT (enterPhase (S, PHASE_MINIMIZE);)               // Most of the time goes to implied
   int* p = S->processed = S->assigned;                 // Loop from tail to front
   while (p >= S->forced) {                             // Only literals on the stack can be MARKed
     if ((S->false[*p] == MARK) && !implied (S, *p)) {  // If MARKed and not implied
@@ -99,6 +263,7 @@ int* analyze (struct solver* S, int* clause) {         // Compute a resolvent fr
     if (!S->reason[abs (*p)]) { lbd += flag; flag = 0; // Increase LBD for a decision with a true flag
       if (size == 1) S->processed = p; }               // And update the processed pointer
     S->false[*(p--)] = 1; }                            // Reset the MARK flag for all variables on the stack
+  STAT (enterPhase (S, PHASE_ANALYZE); S->stats.lbd[(lbd < STATS_LBD) ? lbd : STATS_LBD]++;)
 
   S->fast -= S->fast >>  5; S->fast += lbd << 15;      // Update the fast moving average
   S->slow -= S->slow >> 15; S->slow += lbd <<  5;      // Update the slow moving average
@@ -107,35 +272,56 @@ int* analyze (struct solver* S, int* clause) {         // Compute a resolvent fr
     unassign (S, *(S->assigned--));                    // Unassign all lits between tail & head
   unassign (S, *S->assigned);                          // Assigned now equal to processed
   S->buffer[size] = 0;                                 // Terminate the buffer (and potentially print clause)
+  if (S->exchange && size <= SHARE_SIZE && lbd <= SHARE_LBD) exportClause (S, S->buffer, size); // Share short lemmas
   return addClause (S, S->buffer, size, 0); }          // Add new conflict clause to redundant DB
 
 int propagate (struct solver* S) {                  // Performs unit propagation
-  int forced = S->reason[abs (*S->processed)];      // Initialize forced flag
+  STAT (int phase = enterPhase (S, PHASE_PROPAGATE);)
+  int forced = S->reason[abs (*S->processed)], result = SAT; // Initialize forced flag
   while (S->processed < S->assigned) {              // While unprocessed false literals
-    int lit = *(S->processed++);                    // Get first unprocessed literal
-    int* watch = &S->first[lit];                    // Obtain the first watch pointer
-    while (*watch != END) {                         // While there are watched clauses (watched by lit)
-      int i, unit = 1;                              // Let's assume that the clause is unit
-      int* clause = (S->DB + *watch + 1);           // Get the clause from DB
-      if (clause[-2] ==   0) clause++;              // Set the pointer to the first literal in the clause
-      if (clause[ 0] == lit) clause[0] = clause[1]; // Ensure that the other watched literal is in front
-      for (i = 2; unit && clause[i]; i++)           // Scan the non-watched literals
-        if (!S->false[clause[i]]) {                 // When clause[i] is not false, it is either true or unset
-          clause[1] = clause[i]; clause[i] = lit;   // Swap literals
-          int store = *watch; unit = 0;             // Store the old watch
-          *watch = S->DB[*watch];                   // Remove the watch from the list of lit
-          addWatch (S, clause[1], store); }         // Add the watch to the list of clause[1]
-      if (unit) {                                   // If the clause is indeed unit
-        clause[1] = lit; watch = (S->DB + *watch);  // Place lit at clause[1] and update next watch
-        if ( S->false[-clause[0]]) continue;        // If the other watched literal is satisfied continue
-        if (!S->false[ clause[0]]) {                // If the other watched literal is falsified,
-          assign (S, clause, forced); }             // A unit clause is found, and the reason is set
-        else { if (forced) return UNSAT;            // Found a root level conflict -> UNSAT
-          int* lemma = analyze (S, clause);         // Analyze the conflict return a conflict clause
-          if (!lemma[1]) forced = 1;                // In case a unit clause is found, set forced flag
-          assign (S, lemma, forced); break; } } } } // Assign the conflict clause as a unit
-  if (forced) S->forced = S->processed;             // Set S->forced if applicable
-  return SAT; }                                     // Finally, no conflict was found
+    int lit = *(S->processed++), i, j, *conflict = 0; // Get first unprocessed literal
+    S->nPropagations++;                             // Count the processed literals
+    struct watchList* list = &S->implications[lit]; // Binary clauses first: they never touch the DB
+    for (i = 0; i < list->size; i += 2) {           // Loop over the literals implied by lit being false
+      int imp = list->data[i];                      // The other literal of the binary clause
+      if (S->false[-imp]) continue;                 // Which may be satisfied already,
+      if (!S->false[imp]) imply (S, imp, 1 + list->data[i+1], forced); // or unassigned and becomes true,
+      else { conflict = S->DB + list->data[i+1]; break; } } // or falsified (conflict)
+    list = &S->watches[lit]; int* data = list->data;// Then the watched clauses with at least three literals
+    for (i = j = 0; !conflict && i < list->size; i += 2) { // Keep the watches by copying them from i to j
+      int blocker = data[i], mem = data[i+1];       // A literal of the clause and the offset of the clause
+      if (S->false[-blocker]) {                     // If the blocker is satisfied the clause is not touched
+        data[j++] = blocker; data[j++] = mem; continue; }
+      int k, *clause = S->DB + mem;                 // Get the clause from DB
+      if (clause[0] == lit) clause[0] = clause[1], clause[1] = lit; // Ensure that the other watched literal is in front
+      if (S->false[-clause[0]]) {                   // If the other watched literal is satisfied continue
+        data[j++] = clause[0]; data[j++] = mem; continue; } // and use it as the blocker
+      for (k = 2; clause[k]; k++)                   // Scan the non-watched literals
+        if (!S->false[clause[k]]) break;            // When clause[k] is not false, it is either true or unset
+      if (clause[k]) {                              // Swap literals and move the watch
+        clause[1] = clause[k]; clause[k] = lit;     // to the list of clause[1]
+        addWatch (S, &S->watches[clause[1]], clause[0], mem); continue; }
+      data[j++] = clause[0]; data[j++] = mem;       // The clause is unit or falsified, keep the watch
+      if (!S->false[clause[0]]) {                   // If the other watched literal is not falsified,
+        assign (S, clause, forced); }               // A unit clause is found, and the reason is set
+      else conflict = clause; }                     // Otherwise the clause is falsified
+    while (i < list->size) data[j++] = data[i++];   // Keep the watches after a conflict
+    list->size = j;
+    if (conflict) { if (forced) { result = UNSAT; break; } // Found a root level conflict -> UNSAT
+      STAT (enterPhase (S, PHASE_ANALYZE);)
+      int* lemma = analyze (S, conflict);           // Analyze the conflict return a conflict clause
+      STAT (enterPhase (S, PHASE_PROPAGATE);)
+      if (lemma == NULL) { result = ERROR; break; } // The lemma did not fit in the DB
+      if (!lemma[1]) forced = 1;                    // In case a unit clause is found, set forced flag
+      assign (S, lemma, forced); } }                // Assign the conflict clause as a unit
+  if (result == SAT && forced) S->forced = S->processed; // Set S->forced if applicable
+  if (S->status == ERROR) result = ERROR;           // Memory ran out (while adding a watch)
+  STAT (enterPhase (S, phase);)
+  return result; }                                  // Finally, no conflict was found
+
+int representative (struct solver* S, int lit) {                    // The literal that replaced lit (see substitute)
+  if (S->repr == NULL) return lit;
+  return (lit > 0) ? S->repr[lit] : -S->repr[-lit]; }
 
 int allVariablesAssigned (struct solver* S) {
   int nVarsAssigned = 0;
@@ -146,25 +332,30 @@ int allVariablesAssigned (struct solver* S) {
 int evaluateClauses (struct solver* S) {
   int clauseStatus = 1;
   while (S->processed < S->assigned) {
-    int lit = *(S->processed++);
-    int* watch = &S->first[lit];
-    while (*watch != END) {
-      int i, unit = 1;
-      int *clause = (S->DB + *watch + 1);
-      if (clause[-2] == 0) clause++;
-      if (clause[0] == lit) clause[0] = clause[1];
-      for (i = 2; unit && clause[i]; i++)
-        if (!S->false[clause[i]]) {
-          clause[1] = clause[i]; clause[i] = lit;
-          int store = *watch; unit = 0;
-          *watch = S->DB[*watch];
-          addWatch (S, clause[1], store); }
-      if (unit) {
-        clause[1] = lit; watch = (S->DB + *watch);
-        if (S->false[-clause[0]] || !S->false[ clause[0]]) continue;
-        else {
-          clauseStatus = 0;
-          return clauseStatus; } } } }
+    int lit = *(S->processed++), i, j;
+    struct watchList* list = &S->implications[lit];
+    for (i = 0; i < list->size; i += 2)
+      if (S->false[list->data[i]]) {
+        clauseStatus = 0;
+        return clauseStatus; }
+    list = &S->watches[lit]; int* data = list->data;
+    for (i = j = 0; clauseStatus && i < list->size; i += 2) {
+      int blocker = data[i], mem = data[i+1];
+      if (S->false[-blocker]) {
+        data[j++] = blocker; data[j++] = mem; continue; }
+      int k, *clause = S->DB + mem;
+      if (clause[0] == lit) clause[0] = clause[1], clause[1] = lit;
+      for (k = 2; clause[k]; k++)
+        if (!S->false[clause[k]]) break;
+      if (clause[k]) {
+        clause[1] = clause[k]; clause[k] = lit;
+        addWatch (S, &S->watches[clause[1]], clause[0], mem); continue; }
+      data[j++] = clause[0]; data[j++] = mem;
+      if (S->false[-clause[0]] || !S->false[ clause[0]]) continue;
+      else clauseStatus = 0; }
+    while (i < list->size) data[j++] = data[i++];
+    list->size = j;
+    if (!clauseStatus) return clauseStatus; }
   return clauseStatus; }
 
 int evaluateAssignment (struct solver* S) {
@@ -178,134 +369,884 @@ int evaluateAssignment (struct solver* S) {
 
 int evaluateBuildability (struct solver* S) {
   if (!allVariablesAssigned (S)) {
+    for (int i = 1; i <= S->nVars; i++) {                           // The completion sets the input variables to false, so
+      int r = representative (S, i);                                // an unassigned variable that was replaced by a negated
+      if (r < 0 && !S->false[r] && !S->false[-r]) return 0; }       // representative falsifies the binary clauses between them
     for (int i = 1; i <= S->nVars; i++) {
-      if (!S->model[i] && !S->false[i]) {
-        int lemma = -i;
-        assign (S, &lemma, 0);
+      if (!S->model[i] && !S->false[i] && representative (S, i) == i) { // Equivalent variables follow their representative
+        imply (S, -i, 1, 0);                                          // As in evaluateDecisions (no reason clause)
         if (!evaluateClauses (S)) {
             return 0; } } } }
   return 1; }
 
-void evaluateDecisions (struct solver* S) {
-  propagate (S);
+int evaluateDecisions (struct solver* S) {
+  int consistent = (propagate (S) == SAT);
 
   for (int i = S->nAssignments-1; i >= 0; i--) {
-    int* lemma = &S->assignments[i];
-    if ((S->assignments[i] > 0 && !S->model[S->assignments[i]]) || (S->assignments[i] < 0 && !S->false[S->assignments[i]])) {
-      assign (S, lemma, 0);
-      propagate (S); } } }
+    if ((S->assignments[i] > 0 && !S->model[S->assignments[i]]) || (S->assignments[i] < 0 && !S->false[S->assignments[i]] && !S->false[-S->assignments[i]])) {
+      imply (S, S->assignments[i], 1, 0);                           // No reason clause, but a nonzero reason makes
+      if (propagate (S) == UNSAT) consistent = 0; } }               // propagate treat the consequences as forced
+  for (int i = 0; i < S->nAssignments; i++)
+    if (S->false[S->assignments[i]]) consistent = 0;
+  return consistent; }
 
-void printDecisions (struct solver* S) {
+void extendModel (struct solver* S) {                               // Give the removed variables a value
+  int i, *clause = S->eliminated.data + S->eliminated.size;         // The eliminated clauses are stored as their literals
+  while (clause > S->eliminated.data) {                             // (pivot first) followed by their size
+    int size = *(--clause); clause -= size;                         // Go backwards: the last elimination comes first
+    for (i = 0; i < size; i++) if (S->model[abs (clause[i])] == (clause[i] > 0)) break;
+    if (i == size) S->model[abs (clause[0])] = (clause[0] > 0); }   // Satisfy the clause by its pivot
+  if (S->repr) for (i = 1; i <= S->nVars; i++) {                    // Equivalent variables copy their representative
+    int r = S->repr[i]; if (r != i) S->model[i] = (r > 0) ? S->model[r] : !S->model[-r]; } }
+
+void printDecisions (struct solver* S, int* assumptions, int n) { // Print the implied literals (not the assumptions)
   printf ("v");
   for (int i = 1; i <= S->nVars; i++) {
-    if (S->model[i] && (S->false[-i] == IMPLIED)) {
-      printf (" %i", i); }
-      else if (S->false[i] == IMPLIED) {
-      printf (" %i", -i); } }
+    int r = representative (S, i), j;                   // An equivalent variable has the state of its representative
+    if (S->false[-r] != IMPLIED && S->false[r] != IMPLIED) { // Unassigned or assumed: only the assumption that was
+      if (!S->false[-r] && !S->false[r]) continue;      // decided (the last one, see evaluateDecisions) is not implied,
+      for (j = n - 1; j >= 0 && abs (representative (S, assumptions[j])) != abs (r); j--); // the others on equivalent
+      if (j >= 0 && abs (assumptions[j]) == i) continue; } // variables are (see preprocess)
+    printf (" %i", S->false[-r] ? i : -i); }
   printf ("\n"); }
 
-int solve (struct solver* S) {                                      // Determine satisfiability
-  int decision = S->head;                                           // Initialize the solver
+int solveStep (struct solver* S, int conflicts, int propagations) { // Continue the search started by setting S->decision to
+  long long maxConflicts = (long long) S->nConflicts + conflicts;   // S->head, until the answer is found or the budget of
+  long long maxPropagations = S->nPropagations + propagations;      // conflicts or propagations (negative: no limit) is used up
+  int i;                                                            // (UNKNOWN). All the state is in S, the next call resumes
   for (;;) {                                                        // Main solve loop
+    if (S->exchange && atomic_load_explicit (&S->exchange->result, memory_order_relaxed))
+      return UNKNOWN;                                               // Another solver of the portfolio found the answer
+    if ((conflicts >= 0 && S->nConflicts >= maxConflicts) || (propagations >= 0 && S->nPropagations >= maxPropagations))
+      return UNKNOWN;                                               // Stop before propagating the last decision
     int old_nLemmas = S->nLemmas;                                   // Store nLemmas to see whether propagate adds lemmas
-    if (propagate (S) == UNSAT) return UNSAT;                       // Propagation returns UNSAT for a root level conflict
+    int result = propagate (S);                                     // Propagation returns UNSAT for a root level conflict
+    if (result != SAT) return (result == UNSAT) ? (S->status = UNSAT) : ERROR;
 
     if (S->nLemmas > old_nLemmas) {                                 // If the last decision caused a conflict
-      decision = S->head;                                           // Reset the decision heuristic to head
-      if (S->fast > (S->slow / 100) * 125) {                        // If fast average is substantially larger than slow average
-        S->res = 0; S->fast = (S->slow / 100) * 125; restart (S);   // Restart and update the averages
-        if (S->nLemmas > S->maxLemmas) reduceDB (S, 6); } }         // Reduce the DB when it contains too many lemmas
-
-    while (S->false[decision] || S->false[-decision]) {             // As long as the temporary decision is assigned
-      decision = S->prev[decision]; }                               // Replace it with the next variable in the decision list
-    if (decision == 0) return SAT;                                  // If the end of the list is reached, then a solution is found
-    decision = S->model[decision] ? decision : -decision;           // Otherwise, assign the decision variable based on the model
-    S->false[-decision] = 1;                                        // Assign the decision literal to true (change to IMPLIED-1?)
-    *(S->assigned++) = -decision;                                   // And push it on the assigned stack
-    decision = abs(decision); S->reason[decision] = 0; } }          // Decisions have no reason clauses
-
-void initDatabase (struct solver* S) {
+      S->decision = S->head;                                        // Reset the decision heuristic to head
+      int root = 0;                                                 // Set when the search returns to the root level
+      if (S->fast > (S->slow / 100) * S->margin) {                  // If fast average is substantially larger than slow average
+        S->res = 0; S->fast = (S->slow / 100) * S->margin; restart (S); root = 1; // Restart and update the averages
+        STAT (S->stats.restarts++;) }
+      else if (S->exchange && S->nConflicts >= S->nextImport) {     // Restarts can be rare, so a portfolio also returns to
+        restart (S); root = 1; }                                    // the root level every SHARE_INTERVAL conflicts
+      if (root && S->exchange && ((result = importClauses (S)) != SAT || // Add the lemmas shared by the portfolio and
+                                  (result = propagate (S)) != SAT)) // propagate the imported units before the next decision
+        return (result == UNSAT) ? (S->status = UNSAT) : ERROR;     // (at the root level, so a conflict means UNSAT)
+      if (root && S->nLemmas > S->maxLemmas) reduceDB (S, 6); }     // Reduce the DB when it contains too many lemmas
+
+    int lit = 0;                                                    // The literal to decide next
+    for (i = 0; i < S->nAssignments; i++) {                         // Decide the assumptions (if any) before other variables
+      lit = S->assignments[i];                                      // Get the next assumption
+      if (S->false[lit]) return UNSAT;                              // A falsified assumption means UNSAT under the assumptions
+      if (!S->false[-lit]) break; }                                 // The first unassigned assumption is the next decision
+    if (i == S->nAssignments) {                                     // All assumptions hold, so use the decision list
+      while (S->false[S->decision] || S->false[-S->decision]) {     // As long as the temporary decision is assigned
+        S->decision = S->prev[S->decision]; }                       // Replace it with the next variable in the decision list
+      if (S->decision == 0) { extendModel (S); return SAT; }        // If the end of the list is reached, then a solution is found
+      lit = S->model[S->decision] ? S->decision : -S->decision; }   // Otherwise, assign the decision variable based on the model
+    STAT (S->stats.decisions++;)
+    S->false[-lit] = 1;                                             // Assign the decision literal to true (change to IMPLIED-1?)
+    *(S->assigned++) = -lit;                                        // And push it on the assigned stack
+    S->model[abs (lit)] = (lit > 0); S->reason[abs (lit)] = 0; } }  // Decisions have no reason clauses
+
+int solve (struct solver* S) {                                      // Determine satisfiability
+  S->decision = S->head;                                            // Start at the head of the decision list
+  return solveStep (S, -1, -1); }
+
+int backbone (struct solver* S, int* candidate) {                   // Find the literals that are true in every solution
+  int i, j, nBase = S->nAssignments, *base = S->assignments, result = solve (S); // The assumptions restrict the solutions
+  if (result != SAT) return result;                                 // Without a solution there is no backbone
+  for (i = 1; i <= S->nVars; i++) candidate[i] = S->model[i] ? i : -i; // Every literal of the first model is a candidate
+  restart (S);
+  S->assignments = allocate (nBase + 1);                            // Room for the assumptions and one probe
+  if (S->assignments == NULL) { S->assignments = base; return ERROR; }
+  for (i = 0; i < nBase; i++) S->assignments[i] = base[i];
+  S->nAssignments = nBase + 1;
+  for (i = 1; i <= S->nVars; i++) {                                 // Check the remaining candidates one by one
+    int lit = candidate[i];
+    if (!lit || S->false[-representative (S, lit)]) continue;       // Filtered out, or true at the root level
+    S->assignments[nBase] = -representative (S, lit);               // Look for a solution without lit
+    if ((result = solve (S)) == ERROR) break;
+    if (result == SAT)                                              // The new model (which falsifies lit) filters
+      for (j = i; j <= S->nVars; j++)                               // out every candidate it does not satisfy
+        if (candidate[j] && S->model[j] != (candidate[j] > 0)) candidate[j] = 0;
+    restart (S); }                                                  // Learned clauses are kept for the next checks
+  free (S->assignments); S->assignments = base; S->nAssignments = nBase;
+  return (result == ERROR) ? ERROR : SAT; }
+
+void printBackbone (struct solver* S, int* candidate) {             // Print the core (true) and dead (false) variables
+  int i, nCore = 0, nDead = 0;
+  for (i = 1; i <= S->nVars; i++) nCore += (candidate[i] > 0), nDead += (candidate[i] < 0);
+  printf ("c c%i", nCore);                                          // Same format as the "c d" line of the input
+  for (i = 1; i <= S->nVars; i++) if (candidate[i] > 0) printf (" %i", i);
+  printf ("\nc d%i", nDead);
+  for (i = 1; i <= S->nVars; i++) if (candidate[i] < 0) printf (" %i", i);
+  printf ("\nv");                                                   // And all of them as literals
+  for (i = 1; i <= S->nVars; i++) if (candidate[i]) printf (" %i", candidate[i]);
+  printf ("\n"); }
+
+#ifdef STATS
+void startTiming (struct solver* S, double parseStart) {            // Time the phases from now on (the parsing is done)
+  S->stats.timing = 1; S->stats.start = seconds ();
+  S->stats.time[PHASE_PARSE] = S->stats.start - parseStart; S->stats.phase = PHASE_SEARCH; }
+
+void printStats (struct solver* S) {                                // Print the statistics as comment lines
+  const char* phases[N_PHASES] = { "parse", "search", "propagate", "analyze", "minimize", "reduce" };
+  enterPhase (S, S->stats.phase);                                   // Charge the time of the current phase
+  printf ("c stats decisions %lld\nc stats propagations %lld\nc stats conflicts %i\nc stats restarts %lld\n",
+          S->stats.decisions, S->nPropagations, S->nConflicts, S->stats.restarts);
+  printf ("c stats reductions %lld\nc stats lemmas %i\n", S->stats.reductions, S->nLemmas);
+  printf ("c stats arena_used_bytes %lld\nc stats arena_peak_bytes %lld\nc stats arena_size_bytes %lld\n",
+          (long long) S->mem_used * sizeof (int), (long long) S->stats.maxMemUsed * sizeof (int), (long long) S->mem_size * sizeof (int));
+  printf ("c stats substituted %lld\nc stats eliminated %lld\nc stats subsumed %lld\nc stats strengthened %lld\n",
+          S->stats.substituted, S->stats.eliminated, S->stats.subsumed, S->stats.strengthened);
+  printf ("c stats imported %lld\nc stats dropped %lld\n", S->stats.imported, S->stats.dropped);
+  int i; printf ("c stats lbd");                                    // Number of lemmas with LBD 1, 2, .. 15 and 16 or more
+  for (i = 1; i <= STATS_LBD; i++) printf (" %lld", S->stats.lbd[i]);
+  printf ("\n");
+  if (S->stats.timing) for (i = 0; i < N_PHASES; i++) printf ("c stats time_%s %.6f\n", phases[i], S->stats.time[i]); }
+#else
+void printStats (struct solver* S) { printf ("c STATS NOT COMPILED IN (configure -s)\n"); }
+#endif
+
+struct simplifier { struct solver* S; struct watchList clauses, resolvents, *occ; // The live clauses (offsets in the DB)
+  int *occStore, *stamp, mark, *propagated, *removed, *frozen; long long budget; }; // and the clauses of each literal
+
+int contains (int* clause, int lit) {                               // Deleted clauses start with 0 and contain nothing
+  for (; *clause; clause++) if (*clause == lit) return 1;
+  return 0; }
+
+int removeLiteral (int* clause, int lit) {                          // Remove lit from the clause, return the new size
+  int i, j; for (i = j = 0; clause[i]; i++) if (clause[i] != lit) clause[j++] = clause[i];
+  clause[j] = 0; return j; }
+
+int unit (struct simplifier* P, int lit) {                          // Make lit true at the root level
+  if (P->S->false[lit]) return UNSAT;                               // Its negation is true already
+  if (!P->S->false[-lit]) imply (P->S, lit, 0, 1);                  // The clause is not kept, so there is no reason
+  return SAT; }
+
+int buildOccurrences (struct simplifier* P) {                       // List the clauses of every literal (one block, as attachClauses)
+  struct solver* S = P->S; int i, j, *lit, offset = 0;
+  for (i = j = 0; i < P->clauses.size; i++)                         // Forget the deleted clauses
+    if (S->DB[P->clauses.data[i]]) P->clauses.data[j++] = P->clauses.data[i];
+  P->clauses.size = j;
+  for (i = -S->nVars; i <= S->nVars; i++) {                         // Release the lists of the previous round
+    if (P->occ[i].capacity > 0) free (P->occ[i].data);
+    P->occ[i].size = P->occ[i].capacity = 0; P->occ[i].data = NULL; }
+  free (P->occStore);
+  for (i = 0; i < P->clauses.size; i++)                             // Count the occurrences of each literal
+    for (lit = S->DB + P->clauses.data[i]; *lit; lit++) P->occ[*lit].capacity--;
+  for (i = -S->nVars; i <= S->nVars; i++) offset -= P->occ[i].capacity;
+  P->occStore = (int*) malloc (sizeof (int) * (offset + 1)); offset = 0;
+  if (P->occStore == NULL) { printf ("c OUT OF MEMORY\n"); return ERROR; }
+  for (i = -S->nVars; i <= S->nVars; i++)
+    if (P->occ[i].capacity) P->occ[i].data = P->occStore + offset, offset -= P->occ[i].capacity;
+  for (i = 0; i < P->clauses.size; i++)                             // Fill the lists (in the order of the DB)
+    for (lit = S->DB + P->clauses.data[i]; *lit; lit++) P->occ[*lit].data[P->occ[*lit].size++] = P->clauses.data[i];
+  return OK; }
+
+int propagateUnits (struct simplifier* P) {                         // Remove the root level assignments from the clauses
+  struct solver* S = P->S; int i;                                   // The lists may point to clauses that lost the literal,
+  while (P->propagated < S->assigned) {                             // so every clause is checked with contains
+    int lit = *(P->propagated++);                                   // The false literals of the trail
+    struct watchList* list = &P->occ[-lit];
+    for (i = 0; i < list->size; i++) {                              // Delete the satisfied clauses
+      int* clause = S->DB + list->data[i];
+      if (contains (clause, -lit)) clause[0] = 0; }
+    list = &P->occ[lit];
+    for (i = 0; i < list->size; i++) {                              // And remove the falsified literal from the others
+      int* clause = S->DB + list->data[i];
+      if (!contains (clause, lit)) continue;
+      int size = removeLiteral (clause, lit);
+      if (size == 0) return UNSAT;
+      if (size == 1) { int other = clause[0]; clause[0] = 0;        // Units are kept on the trail only
+        if (unit (P, other) == UNSAT) return UNSAT; } } }
+  return SAT; }
+
+int substitute (struct simplifier* P, int* found) {                 // Replace equivalent literals by a representative:
+  struct solver* S = P->S; int i, j, n = S->nVars, *lit, result = SAT; // the strongly connected components of the binary
+  int* memory = allocate (5 * (2*n+1));                             // implication graph (Tarjan, without recursion)
+  if (memory == NULL) return ERROR;
+  int *index = memory + n, *low = index + 2*n+1, *edge = low + 2*n+1, *stack = edge + n+1, *calls = stack + 2*n+1;
+  int nStack = 0, nCalls = 0, count = 0; *found = 0;
+  for (i = -n; i <= n; i++) {
+    if (!i || index[i] || S->false[i] || S->false[-i] || S->repr[abs (i)] != abs (i)) continue;
+    calls[nCalls++] = stack[nStack++] = i; index[i] = low[i] = ++count;
+    while (nCalls) {
+      int u = calls[nCalls - 1]; struct watchList* list = &P->occ[-u]; // The edges u -> v are the binary clauses (-u v)
+      for (; edge[u] < list->size; edge[u]++) {
+        int* clause = S->DB + list->data[edge[u]];
+        if (!clause[0] || !clause[1] || clause[2] || !contains (clause, -u)) continue;
+        int v = (clause[0] == -u) ? clause[1] : clause[0];
+        if (!index[v]) { calls[nCalls++] = stack[nStack++] = v; index[v] = low[v] = ++count; break; }
+        if (index[v] > 0 && index[v] < low[u]) low[u] = index[v]; } // v is on the stack (finished literals are negated)
+      if (edge[u] < list->size) continue;                           // Visit v first
+      if (--nCalls && low[u] < low[calls[nCalls - 1]]) low[calls[nCalls - 1]] = low[u];
+      if (low[u] != index[u]) continue;                             // Otherwise u is the root of a component
+      int first = nStack, rep = u; P->mark++;
+      do { int l = stack[--first]; P->stamp[l] = P->mark;           // The representative has the smallest variable
+        if (abs (l) < abs (rep)) rep = l; } while (stack[first] != u);
+      for (j = first; j < nStack; j++) { int l = stack[j]; index[l] = -index[l];
+        if (P->stamp[-l] == P->mark) { result = UNSAT; goto done; } // Both l and -l are in the component
+        if (l != rep && !P->frozen[abs (l)]) S->repr[abs (l)] = (l > 0) ? rep : -rep, (*found)++; }
+      nStack = first; } }
+  *found /= 2;                                                      // Every component has a mirror with the negations
+  STAT (S->stats.substituted += *found;)
+
+  for (i = 0; *found && i < P->clauses.size; i++) {                 // Rewrite the clauses with the representatives
+    int* clause = S->DB + P->clauses.data[i], size = 0;
+    for (lit = clause; *lit; lit++) if (S->repr[abs (*lit)] != abs (*lit)) break;
+    if (!*lit) continue;                                            // Nothing to replace (or deleted)
+    P->mark++;
+    for (lit = clause; *lit; lit++) { int l = representative (S, *lit);
+      if (P->stamp[-l] == P->mark) break;                           // A tautology
+      if (P->stamp[l] != P->mark) P->stamp[l] = P->mark, clause[size++] = l; } // Without duplicates
+    if (*lit) { clause[0] = 0; continue; }
+    clause[size] = 0;
+    if (size == 1) { int other = clause[0]; clause[0] = 0;
+      if (unit (P, other) == UNSAT) { result = UNSAT; break; } } }
+  done: free (memory);
+  return result; }
+
+int subsume (struct simplifier* P) {                                // Remove subsumed clauses and strengthen clauses by
+  struct solver* S = P->S; int i, j, k, *lit;                       // self-subsuming resolution (until the budget is used)
+  for (i = 0; i < P->clauses.size && P->budget > 0; i++) {
+    int mem = P->clauses.data[i], *clause = S->DB + mem, size = 0, best = 0;
+    if (!clause[0]) continue;
+    P->mark++;
+    for (lit = clause; *lit; lit++, size++) { P->stamp[*lit] = P->mark; // Mark the literals of the clause, and find the
+      if (!best || P->occ[*lit].size + P->occ[-*lit].size < P->occ[best].size + P->occ[-best].size) best = *lit; } // rarest
+    for (k = 0; k < 2; k++, best = -best) {                         // Every candidate contains best (or -best, if strengthened)
+      struct watchList* list = &P->occ[best];
+      for (j = 0; j < list->size; j++) {
+        int* other = S->DB + list->data[j], matched = 0, flipped = 0, flip = 0;
+        if (list->data[j] == mem || !contains (other, best)) continue;
+        for (lit = other; *lit; lit++) {
+          if (P->stamp[*lit] == P->mark) matched++;
+          else if (P->stamp[-*lit] == P->mark) flipped++, flip = *lit; }
+        P->budget -= lit - other;
+        if (matched + flipped != size || flipped > 1) continue;     // Not all literals of the clause are in the other
+        if (!flipped) { other[0] = 0; STAT (S->stats.subsumed++;) continue; }
+        STAT (S->stats.strengthened++;)
+        if (removeLiteral (other, flip) == 1) { int u = other[0]; other[0] = 0; // The other clause becomes a unit
+          if (unit (P, u) == UNSAT) return UNSAT; } } } }
+  return propagateUnits (P); }
+
+int eliminate (struct simplifier* P) {                              // Bounded variable elimination: replace the clauses of a
+  struct solver* S = P->S; int v, i, j, k, *lit, *p, *q;            // variable by their resolvents, if there are not more of them
+  for (v = 1; v <= S->nVars && P->budget > 0; v++) {
+    if (S->false[v] || S->false[-v] || S->repr[v] != v || P->frozen[v]) continue; // Assigned, substituted or frozen
+    struct watchList *pos = &P->occ[v], *neg = &P->occ[-v];
+    int nPos = 0, nNeg = 0, nResolvents = 0, size, ok = 1;
+    for (i = 0; i < pos->size; i++) if (contains (S->DB + pos->data[i], v)) pos->data[nPos++] = pos->data[i];
+    for (i = 0; i < neg->size; i++) if (contains (S->DB + neg->data[i], -v)) neg->data[nNeg++] = neg->data[i];
+    pos->size = nPos; neg->size = nNeg;                             // Only keep the clauses that contain the literal
+    if (nPos + nNeg == 0 || (long long) nPos * nNeg > ELIMINATE_PAIRS) continue;
+    P->resolvents.size = 0;
+    for (i = 0; ok && i < nPos; i++) {
+      p = S->DB + pos->data[i]; P->mark++;
+      for (lit = p; *lit; lit++) P->stamp[*lit] = P->mark;
+      for (j = 0; ok && j < nNeg; j++) {
+        q = S->DB + neg->data[j]; size = 0;
+        P->budget -= 2 * ELIMINATE_SIZE;
+        for (lit = q; *lit; lit++) if (*lit != -v && P->stamp[-*lit] == P->mark) break;
+        if (*lit) continue;                                         // The resolvent is a tautology
+        for (lit = p; *lit; lit++) if (*lit != v) S->buffer[size++] = *lit;
+        for (lit = q; *lit; lit++) if (*lit != -v && P->stamp[*lit] != P->mark) S->buffer[size++] = *lit;
+        if (size > ELIMINATE_SIZE || ++nResolvents > nPos + nNeg) { ok = 0; break; } // Not worth it
+        for (k = 0; k < size; k++) if (push (&P->resolvents, S->buffer[k]) == ERROR) return ERROR;
+        if (push (&P->resolvents, 0) == ERROR) return ERROR; } }
+    if (!ok) continue;
+
+    STAT (S->stats.eliminated++;) P->removed[v] = 1;
+    for (k = 0; k < 2; k++) {                                       // Keep the clauses to extend the model (see extendModel)
+      struct watchList* list = k ? neg : pos; int pivot = k ? -v : v;
+      for (i = 0; i < list->size; i++) {
+        int* clause = S->DB + list->data[i]; size = 0;
+        if (push (&S->eliminated, pivot) == ERROR) return ERROR;    // The pivot first
+        for (lit = clause; *lit; lit++)
+          if (*lit != pivot) { size++; if (push (&S->eliminated, *lit) == ERROR) return ERROR; }
+        if (push (&S->eliminated, size + 1) == ERROR) return ERROR;
+        clause[0] = 0; }                                            // And delete them
+      list->size = 0; }
+    for (i = 0; i < P->resolvents.size; i = j + 1) {                // Add the resolvents
+      for (j = i; P->resolvents.data[j]; j++);
+      if (j - i == 1) { if (unit (P, P->resolvents.data[i]) == UNSAT) return UNSAT; continue; }
+      int mem = S->mem_used;                                        // The DB may move: use offsets
+      if (storeClause (S, P->resolvents.data + i, j - i) == NULL || push (&P->clauses, mem) == ERROR) return ERROR;
+      for (k = i; k < j; k++) if (push (&P->occ[P->resolvents.data[k]], mem) == ERROR) return ERROR; }
+    if (propagateUnits (P) == UNSAT) return UNSAT; }
+  return SAT; }
+
+void unlinkVariable (struct solver* S, int var) {                   // Remove var from the decision list
+  if (var == S->head) S->head = S->prev[var];
+  else S->prev[S->next[var]] = S->prev[var];
+  S->next[S->prev[var]] = S->next[var]; }
+
+int preprocess (struct solver* S, int level) {                      // Simplify the input clauses (before they are watched)
+  struct simplifier simplifier, *P = &simplifier;
+  int i, j, k, n = S->nVars, found, result = ERROR, *lit;
+  memset (P, 0, sizeof (struct simplifier)); P->S = S; P->propagated = S->falseStack;
+  P->occ = (struct watchList*) calloc (2*n+1, sizeof (struct watchList));
+  P->stamp = allocate (2*n+1); P->removed = allocate (n+1); P->frozen = allocate (n+1); S->repr = allocate (n+1);
+  if (P->occ) P->occ += n; else printf ("c OUT OF MEMORY\n");
+  if (P->stamp) P->stamp += n;
+  if (!P->occ || !P->stamp || !P->removed || !P->frozen || !S->repr) goto done;
+  for (i = 1; i <= n; i++) S->repr[i] = i;
+  for (i = 0; i < S->nAssignments; i++)                             // The variables of the "c v" line keep their identity,
+    if (S->assignments[i] && abs (S->assignments[i]) <= n) P->frozen[abs (S->assignments[i])] = 1; // as --propagate reports them
+
+  for (i = 0; i < S->mem_used; i++) {                               // Collect the clauses, without duplicate literals
+    int head = i, size = 0; P->mark++;                              // and tautologies (the units are on the trail)
+    for (; S->DB[i]; i++) {
+      if (P->stamp[-S->DB[i]] == P->mark) size = -1;
+      if (size >= 0 && P->stamp[S->DB[i]] != P->mark) P->stamp[S->DB[i]] = P->mark, S->DB[head + size++] = S->DB[i]; }
+    if (size < 2) { if (size == 1 && unit (P, S->DB[head]) == UNSAT) { result = UNSAT; goto done; } continue; }
+    S->DB[head + size] = 0;
+    if (push (&P->clauses, head) == ERROR) goto done; }
+
+  if (buildOccurrences (P) == ERROR) goto done;
+  if ((result = propagateUnits (P)) != SAT) goto done;
+  for (k = 0; k < SUBSTITUTE_ROUNDS; k++) {                         // Equivalences can create new equivalences
+    if ((result = substitute (P, &found)) != SAT) goto done;
+    if (!found) break;
+    for (i = 1; i <= n; i++) S->repr[i] = representative (S, S->repr[i]); // Follow the chains of earlier rounds
+    if (buildOccurrences (P) == ERROR || (result = propagateUnits (P)) != SAT) goto done; }
+  P->budget = SUBSUME_BUDGET;
+  if ((result = subsume (P)) != SAT) goto done;
+  if (level == SIMPLIFY_ALL) {
+    P->budget = ELIMINATE_BUDGET;
+    if (buildOccurrences (P) == ERROR || (result = eliminate (P)) != SAT) goto done; }
+
+  for (i = 1; i <= n; i++)                                          // The removed variables are never decided
+    if (P->removed[i] || S->repr[i] != i) unlinkVariable (S, i);
+  int nUnits = 0;                                                   // Take the units off the trail
+  while (S->assigned > S->falseStack) {
+    int lit = *(--S->assigned); S->false[lit] = 0; S->buffer[nUnits++] = -lit; }
+  S->processed = S->forced = S->falseStack;
+  for (i = 0, S->mem_used = 0; i < P->clauses.size; i++) {          // Compact the remaining clauses (in the same order)
+    int* clause = S->DB + P->clauses.data[i];
+    if (!clause[0]) continue;
+    for (lit = clause, j = S->mem_used; *lit; lit++) S->DB[j++] = *lit;
+    S->DB[j] = 0; S->mem_used = j + 1; }
+  for (k = nUnits - 1; k >= 0; k--) {                               // And store the units again (as clauses of the DB)
+    int* clause = storeClause (S, &S->buffer[k], 1);
+    if (clause == NULL) { result = ERROR; goto done; }
+    assign (S, clause, 1); }
+  for (i = 1; i <= n; i++) if (S->repr[i] != i) break;
+  if (i > n) free (S->repr), S->repr = NULL;                        // Nothing was substituted
+  result = SAT;
+
+  done: if (P->occ) {
+    for (i = -n; i <= n; i++) if (P->occ[i].capacity > 0) free (P->occ[i].data);
+    free (P->occ - n); }
+  if (P->stamp) free (P->stamp - n);
+  free (P->occStore); free (P->removed); free (P->frozen); free (P->clauses.data); free (P->resolvents.data);
+  return result; }
+
+int initDatabase (struct solver* S, int m) {
+  S->DB = NULL; S->mem_size = 0;                      // The DB grows when needed, starting with a guess
   S->mem_used       = 0;                              // The number of integers allocated in the DB
-  S->DB = (int *) malloc (sizeof (int) * MEM_MAX);    // Allocate the initial database
-  S->DB[S->mem_used++] = 0; }                         // Make sure there is a 0 before the clauses are loaded
+  S->mem_fixed      = 0;                              // The number of integers used by the input clauses
+  return resizeDB (S, 1024 + 4 * m); }                // Allocate room for m clauses of three literals
 
-void initCDCL (struct solver* S, int n, int m) {
+int initCDCL (struct solver* S, int n, int m) {
   if (n < 1)      n = 1;                  // The code assumes that there is at least one variable
   S->nVars          = n;                  // Set the number of variables
   S->nClauses       = m;                  // Set the number of clauses
   S->nLemmas        = 0;                  // The number of learned clauses -- redundant means learned
   S->nConflicts     = 0;                  // Under of conflicts which is used to updates scores
+  S->nPropagations  = 0;                  // Number of false literals processed by propagate
   S->maxLemmas      = 2000;               // Initial maximum number of learnt clauses
   S->res = 0;                             // Initialize restarts
+  S->status         = SAT;                // Becomes UNSAT once a root level conflict is found
   S->fast = S->slow = 1 << 24;            // Initialize the fast and slow moving averages
+  S->margin         = 125;                // Restart if fast is more than 125% of slow
+  S->exchange       = NULL;               // Only set for the solvers of a portfolio
+  S->nImported      = NULL;               // Number of lemmas imported from each solver of the portfolio
+  S->nextImport     = 0;                  // The number of conflicts at which the portfolio imports next
+  S->id             = 0;                  // Index in the portfolio
+  S->repr           = NULL;               // Set if preprocessing replaced equivalent variables
+  S->eliminated.size = S->eliminated.capacity = 0; S->eliminated.data = NULL; // Clauses removed by BVE
+  STAT (memset (&S->stats, 0, sizeof (struct stats));) // Start counting (phase parse, no timing yet)
 
-  S->model       = getMemory (S, n+1); // Full assignment of the (Boolean) variables (initially set to false)
-  S->next        = getMemory (S, n+1); // Next variable in the heuristic order
-  S->prev        = getMemory (S, n+1); // Previous variable in the heuristic order
-  S->buffer      = getMemory (S, n  ); // A buffer to store a temporary clause
-  S->reason      = getMemory (S, n+1); // Array of clauses
-  S->falseStack  = getMemory (S, n+1); // Stack of falsified literals -- this pointer is never changed
+  if (initDatabase (S, m) == ERROR) return ERROR; // The DB only contains clauses, it can be moved when it grows
+  S->model       = allocate (n+1);     // Full assignment of the (Boolean) variables (initially set to false)
+  S->next        = allocate (n+1);     // Next variable in the heuristic order
+  S->prev        = allocate (n+1);     // Previous variable in the heuristic order
+  S->buffer      = allocate (n  );     // A buffer to store a temporary clause
+  S->reason      = allocate (n+1);     // Array of clauses
+  S->falseStack  = allocate (2*n+1);   // Stack of falsified literals (and assumptions) -- this pointer is never changed
   S->forced      = S->falseStack;      // Points inside *falseStack at first decision (unforced literal)
   S->processed   = S->falseStack;      // Points inside *falseStack at first unprocessed literal
   S->assigned    = S->falseStack;      // Points inside *falseStack at last unprocessed literal
-  S->false       = getMemory (S, 2*n+1); S->false += n; // Labels for variables, non-zero means false
-  S->first       = getMemory (S, 2*n+1); S->first += n; // Offset of the first watched clause
+  S->false       = allocate (2*n+1);   // Labels for variables, non-zero means false
+  S->watches      = (struct watchList*) calloc (2*n+1, sizeof (struct watchList)); // Watched clauses (and blockers) per literal
+  S->implications = (struct watchList*) calloc (2*n+1, sizeof (struct watchList)); // Binary clauses per literal
+  if (!S->watches || !S->implications) printf ("c OUT OF MEMORY\n");
+  if (!S->model || !S->next || !S->prev || !S->buffer || !S->reason || !S->falseStack || !S->false ||
+      !S->watches || !S->implications) return ERROR;      // Out of memory
+  S->false += n; S->watches += n; S->implications += n; S->watchStore = NULL;
 
   int i; for (i = 1; i <= n; i++) {                        // Initialize the main data structures:
-    S->prev [i] = i - 1; S->next[i-1] = i;                 // the double-linked list for variable-move-to-front,
-    S->model[i] = S->false[-i] = S->false[i] = 0;          // the model (phase-saving), the false array,
-    S->first[i] = S->first[-i] = END; }                    // and first (watch pointers).
-  S->head = n; }                                           // Initialize the head of the double-linked list
+    S->prev [i] = i - 1; S->next[i-1] = i;                 // the double-linked list for variable-move-to-front, and
+    S->model[i] = S->false[-i] = S->false[i] = 0; }        // the model (phase-saving) and the false array.
+  S->head = S->decision = n; return OK; }                  // Initialize the head of the double-linked list
+
+void freeSolver (struct solver* S) {                               // Release the memory of the solver
+  free (S->DB); free (S->model); free (S->next); free (S->prev); free (S->buffer); free (S->reason);
+  free (S->falseStack); free (S->false - S->nVars);
+  int i; for (i = -S->nVars; i <= S->nVars; i++) {               // Lists that grew out of the watch store
+    if (S->watches[i].capacity > 0) free (S->watches[i].data);
+    if (S->implications[i].capacity > 0) free (S->implications[i].data); }
+  free (S->watches - S->nVars); free (S->implications - S->nVars); free (S->watchStore);
+  free (S->repr); free (S->eliminated.data); }
+
+int parseInt (const char** in, const char* end, int* value) {             // Read an integer (skips white space)
+  const char* p = *in; int sign = 1, n = 0;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+  if (p < end && *p == '-') sign = -1, p++;
+  if (p == end || *p < '0' || *p > '9') { *in = p; return 0; }            // No number at the current position
+  while (p < end && *p >= '0' && *p <= '9') n = 10 * n + (*(p++) - '0');
+  *in = p; *value = sign * n; return 1; }
+
+int validLiterals (int* lits, int count, int n) {                  // Check that lits only contains literals of n variables
+  int i; for (i = 0; i < count; i++) if (lits[i] < -n || lits[i] > n) return 0; // (or zeros)
+  return 1; }
+
+int parseList (const char** in, const char* end, int** list, int* size) { // Read a count followed by count integers
+  int i, n; if (!parseInt (in, end, &n) || n < 0) return OK;              // As in "c v3 1 -2 4" (may span lines)
+  if ((*list = allocate (n)) == NULL) return ERROR;
+  for (i = 0; i < n; i++)
+    if (!parseInt (in, end, &(*list)[i])) { printf ("c PARSE ERROR\n"); return ERROR; }
+  *size = n; return OK; }
+
+int parseBuffer (struct solver* S, const char* in, size_t length, int simplify) { // Parse the formula in a single pass over memory
+  const char* end = in + length; int nZeros = -1, size = 0, lit, i;       // Clauses are only read after the problem line
+  char* seen = NULL; int tautology = 0;                                   // The literals of the current clause
+  S->nAssignments = S->nDead = 0; S->assignments = S->dead = NULL;
+  while (nZeros) {
+    while (in < end && (*in == ' ' || *in == '\t' || *in == '\n' || *in == '\r')) in++;
+    if (in == end) { if (!size) break; lit = 0; }                         // A missing final 0 still ends the last clause
+    else if (*in == 'c') { in++;                                          // A comment line: look for "c v" and "c d"
+      while (in < end && (*in == ' ' || *in == '\t')) in++;
+      int result = OK;
+      if (in < end && *in == 'v' && !S->assignments) in++, result = parseList (&in, end, &S->assignments, &S->nAssignments);
+      else if (in < end && *in == 'd' && !S->dead) in++, result = parseList (&in, end, &S->dead, &S->nDead);
+      if (result == ERROR) goto fail;                                     // The message is already printed
+      while (in < end && *in != '\n') in++;                               // Skip the rest of the line
+      continue; }
+    else if (*in == 'p') { in++;                                          // The problem line "p cnf nVars nClauses"
+      while (in < end && (*in == ' ' || *in == '\t')) in++;
+      if (nZeros >= 0 || end - in < 3 || strncmp (in, "cnf", 3)) goto error;
+      in += 3; int n, m;
+      if (!parseInt (&in, end, &n) || !parseInt (&in, end, &m) || n < 0 || m < 0) goto error;
+      nZeros = m;                                                         // Initialize the number of clauses to read
+      if (initCDCL (S, n, m) == ERROR) goto fail;                         // Allocate the main datastructures
+      if ((seen = (char*) calloc (2 * S->nVars + 1, 1)) == NULL) { printf ("c OUT OF MEMORY\n"); goto fail; }
+      seen += S->nVars; continue; }
+    else if (nZeros < 0 || !parseInt (&in, end, &lit) || abs (lit) > S->nVars) goto error;
+    if (lit) { if (seen[-lit]) tautology = 1;                             // Drop tautologies and duplicate literals, so
+      else if (!seen[lit]) seen[lit] = 1, S->buffer[size++] = lit;        // clauses are at most nVars literals long
+      continue; }                                                         // Add literal to buffer
+    for (i = 0; i < size; i++) seen[S->buffer[i]] = 0;                    // Reaching the end of the clause: add it
+    if (tautology) { size = tautology = 0; --nZeros; continue; }          // (unless it is always satisfied)
+    int* clause = storeClause (S, S->buffer, size);
+    if (clause == NULL) goto fail;
+    if (!size || ((size == 1) && S->false[clause[0]])) goto unsat;        // Check for empty clause or conflicting unit
+    if ((size == 1) && !S->false[-clause[0]]) {                           // Check for a new unit
+      assign (S, clause, 1); }                                            // Directly assign new units (forced = 1)
+    size = 0; --nZeros; }                                                 // Reset buffer
+  if (nZeros < 0) goto error;                                             // No problem line was found
+  if (!validLiterals (S->assignments, S->nAssignments, S->nVars) ||       // The "c v" and "c d" lines may come before it,
+      !validLiterals (S->dead, S->nDead, S->nVars)) goto error;           // so they are checked at the end
+  free (seen - S->nVars); seen = NULL;
+  if (simplify) { int result = preprocess (S, simplify);                  // Optionally simplify the clauses (see SIMPLIFY)
+    if (result == UNSAT) goto unsat;
+    if (result == ERROR) goto fail;
+    for (int i = 0; i < S->nAssignments; i++)                             // The "c v" line refers to the input variables
+      if (S->assignments[i]) S->assignments[i] = representative (S, S->assignments[i]); }
+  S->mem_fixed = S->mem_used;                                             // All clauses so far are input clauses
+  if (attachClauses (S) == OK) return SAT;                                // Watch them (a single allocation)
+  goto fail;
+
+  unsat: if (!validLiterals (S->assignments, S->nAssignments, S->nVars) ||
+             !validLiterals (S->dead, S->nDead, S->nVars)) goto error;
+  if (seen) free (seen - S->nVars);                                       // Found an empty clause or a conflicting unit:
+  S->mem_used = S->mem_fixed = 0;                                         // the clauses are not needed anymore
+  return S->status = UNSAT;
+
+  error: printf ("c PARSE ERROR\n");                                      // Malformed input
+  fail: if (seen) free (seen - S->nVars);
+  if (nZeros >= 0) freeSolver (S);                                        // Release everything (nothing is usable)
+  free (S->assignments); free (S->dead); S->assignments = S->dead = NULL;
+  return ERROR; }
+
+const char* mapFile (char* filename, size_t* length) {                   // Map the CNF file into memory (NULL on failure)
+  struct stat info; int fd = open (filename, O_RDONLY);
+  if (fd < 0 || fstat (fd, &info)) { printf ("c FILE NOT FOUND\n"); if (fd >= 0) close (fd); return NULL; }
+  const char* data = ""; *length = info.st_size;
+  if (*length) data = mmap (NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0); // No copy of the file is made
+  close (fd);                                                             // The mapping stays valid
+  if (data == MAP_FAILED) { printf ("c FILE NOT FOUND\n"); return NULL; }
+  return data; }
+
+void unmapFile (const char* data, size_t length) {
+  if (length) munmap ((void*) data, length); }
 
 int parse (struct solver* S, char* filename) {                            // Parse the formula and initialize
-  int tmp; FILE* input = fopen (filename, "r");                           // Read the CNF file
-  if (input == NULL) printf ("c FILE NOT FOUND\n"), exit (ERROR);         // Exit if file not found
-
-  initDatabase(S);
-
-  if (MODE == MODE_PROPAGATE) {                                           // Parse the additional comment lines
-    int i;
-    do { tmp = fscanf (input, " c v%i", &S->nAssignments);                // Parse assigned variables
-      if (tmp > 0 && tmp != EOF) break; tmp = fscanf (input, "%*s\n"); }  // Skip rest of line
-    while (tmp != 1 && tmp != EOF);
-    S->assignments = getMemory (S, S->nAssignments);
-    i = 0;
-    while (i < S->nAssignments) {
-      fscanf (input, "%i", &S->assignments[i++]); }
-    fseek (input, 0, SEEK_SET);                                           // Reset file position
-  }
-
-  do { tmp = fscanf (input, " p cnf %i %i \n", &S->nVars, &S->nClauses);  // Find the first non-comment line
-    if (tmp > 0 && tmp != EOF) break; tmp = fscanf (input, "%*s\n"); }    // In case a comment line was found
-  while (tmp != 2 && tmp != EOF);                                         // Skip it and read next line
-
-  initCDCL (S, S->nVars, S->nClauses);                     // Allocate the main datastructures
-  int nZeros = S->nClauses, size = 0;                      // Initialize the number of clauses to read
-  while (nZeros > 0) {                                     // While there are clauses in the file
-    int lit = 0; tmp = fscanf (input, " %i ", &lit);       // Read a literal.
-    if (!lit) {                                            // If reaching the end of the clause
-      int* clause = addClause (S, S->buffer, size, 1);     // Then add the clause to data_base
-      if (!size || ((size == 1) && S->false[clause[0]]))   // Check for empty clause or conflicting unit
-        return UNSAT;                                      // If either is found return UNSAT
-      if ((size == 1) && !S->false[-clause[0]]) {          // Check for a new unit
-        assign (S, clause, 1); }                           // Directly assign new units (forced = 1)
-      size = 0; --nZeros; }                                // Reset buffer
-    else S->buffer[size++] = lit; }                        // Add literal to buffer
-  fclose (input);                                          // Close the formula file
-  return SAT; }                                            // Return that no conflict was observed
+  size_t length; const char* data = mapFile (filename, &length);
+  if (data == NULL) return ERROR;
+  int result = parseBuffer (S, data, length, SIMPLIFY_NONE);
+  unmapFile (data, length);
+  return result; }
+
+void appendInts (int** out, const int* from, int count) {           // Copy count ints to *out and advance it
+  if (count) memcpy (*out, from, sizeof (int) * count);
+  *out += count; }
+
+void readInts (const char** in, int* to, int count) {               // Copy count ints from *in (which may be unaligned)
+  if (count) memcpy (to, *in, sizeof (int) * count);
+  *in += sizeof (int) * count; }
+
+long long snapshotLength (struct snapshot* H) {                     // The number of ints of a snapshot (see writeSnapshot)
+  return sizeof (struct snapshot) / sizeof (int) + H->mem_used + 4LL * (H->nVars + 1) + H->nAssigned +
+         2LL * (2 * H->nVars + 1) + H->nWatches + H->nAssignments + H->nDead + H->nRepr + H->nEliminated; }
+
+int* writeSnapshot (struct solver* S, int lemmas) {                 // Copy the solver (at the root level) into one block:
+  struct snapshot H; int i, j, k, n = S->nVars, *out;               // the header, the DB, the arrays of the variables, the
+  int mem = lemmas ? S->mem_used : S->mem_fixed;                    // trail, the watch lists and the preprocessing results
+  struct watchList* lists[2] = { S->watches, S->implications };
+  memset (&H, 0, sizeof (H));
+  for (i = -n; i <= n; i++) for (k = 0; k < 2; k++)                 // Count the watches of the clauses that are kept
+    for (j = 0; j < lists[k][i].size; j += 2) H.nWatches += (lists[k][i].data[j+1] < mem) ? 2 : 0;
+  H.magic = SNAPSHOT_MAGIC; H.version = SNAPSHOT_VERSION; H.status = S->status;
+  H.nVars = n; H.nClauses = S->nClauses; H.mem_used = mem; H.mem_fixed = S->mem_fixed;
+  H.nLemmas = lemmas ? S->nLemmas : 0; H.maxLemmas = S->maxLemmas; H.head = S->head; H.fast = S->fast; H.slow = S->slow;
+  H.nAssigned = S->assigned - S->falseStack; H.nProcessed = S->processed - S->falseStack; H.nForced = S->forced - S->falseStack;
+  H.nAssignments = S->nAssignments; H.nDead = S->nDead; H.nRepr = S->repr ? n + 1 : 0; H.nEliminated = S->eliminated.size;
+  long long length = snapshotLength (&H);
+  int* snapshot = (length <= MEM_MAX) ? (int*) malloc (sizeof (int) * length) : NULL;
+  if (snapshot == NULL) { printf ("c OUT OF MEMORY\n"); return NULL; }
+  H.length = (int) length; out = snapshot;
+  appendInts (&out, (int*) &H, sizeof (H) / sizeof (int));
+  appendInts (&out, S->DB, mem);                                    // Clauses are referred to by offsets, so they stay valid
+  appendInts (&out, S->model, n+1); appendInts (&out, S->next, n+1); appendInts (&out, S->prev, n+1);
+  appendInts (&out, S->reason, n+1);                                // Reasons on the root level are only tested for zero,
+  appendInts (&out, S->falseStack, H.nAssigned);                    // so they may point to lemmas that are not kept
+  for (k = 0; k < 2; k++) for (i = -n; i <= n; i++) {               // The sizes of the lists
+    int size = 0; for (j = 0; j < lists[k][i].size; j += 2) size += (lists[k][i].data[j+1] < mem) ? 2 : 0;
+    *(out++) = size; }
+  for (i = -n; i <= n; i++) for (k = 0; k < 2; k++)                 // and their pairs, in the order of attachClauses
+    for (j = 0; j < lists[k][i].size; j += 2)
+      if (lists[k][i].data[j+1] < mem) { *(out++) = lists[k][i].data[j]; *(out++) = lists[k][i].data[j+1]; }
+  appendInts (&out, S->assignments, H.nAssignments); appendInts (&out, S->dead, H.nDead);
+  appendInts (&out, S->repr, H.nRepr); appendInts (&out, S->eliminated.data, H.nEliminated);
+  return snapshot; }
+
+int loadSnapshot (struct solver* S, const char* in, size_t length) { // Restore a solver from a snapshot (no parsing)
+  struct snapshot H; int i, k, n, offset = 0, initialized = 0;
+  S->nAssignments = S->nDead = 0; S->assignments = S->dead = NULL;
+  if (length < sizeof (H)) goto invalid;
+  readInts (&in, (int*) &H, sizeof (H) / sizeof (int)); n = H.nVars;
+  if (H.magic != SNAPSHOT_MAGIC || H.version != SNAPSHOT_VERSION) goto invalid;
+  if (n < 1 || (H.status != SAT && H.status != UNSAT) || H.nClauses < 0 || H.mem_fixed < 0 || H.mem_used < H.mem_fixed ||
+      H.head < 0 || H.head > n ||
+      H.nForced < 0 || H.nForced > H.nProcessed || H.nProcessed > H.nAssigned || H.nAssigned > n || H.nWatches < 0 ||
+      H.nAssignments < 0 || H.nDead < 0 || (H.nRepr && H.nRepr != n + 1) || H.nEliminated < 0 ||
+      H.length != snapshotLength (&H) || length != sizeof (int) * (size_t) H.length) goto invalid;
+  if (initCDCL (S, n, H.nClauses) == ERROR) goto fail;              // Allocate the arrays as the parser does
+  initialized = 1;
+  if (H.mem_used > S->mem_size && resizeDB (S, H.mem_used) == ERROR) goto fail;
+  readInts (&in, S->DB, H.mem_used); readInts (&in, S->model, n+1);
+  readInts (&in, S->next, n+1); readInts (&in, S->prev, n+1); readInts (&in, S->reason, n+1);
+  readInts (&in, S->falseStack, H.nAssigned);
+  if (!validLiterals (S->DB, H.mem_used, n) || (H.mem_used && S->DB[H.mem_used - 1])) goto invalid; // Every clause ends with 0
+  for (i = 0; i <= n; i++) if (S->next[i] < 0 || S->next[i] > n || S->prev[i] < 0 || S->prev[i] > n) goto invalid;
+  for (i = 0; i < H.nAssigned; i++) {                               // Restore the labels of the trail
+    if (!S->falseStack[i] || abs (S->falseStack[i]) > n) goto invalid;
+    S->false[S->falseStack[i]] = IMPLIED; }
+  S->assigned = S->falseStack + H.nAssigned; S->processed = S->falseStack + H.nProcessed; S->forced = S->falseStack + H.nForced;
+  for (k = 0; k < 2; k++) for (i = -n; i <= n; i++) {
+    struct watchList* list = k ? &S->implications[i] : &S->watches[i];
+    readInts (&in, &list->size, 1); list->capacity = -list->size;  // Exact slices of the watch store (see attachClauses)
+    if (list->size < 0 || list->size % 2 || (offset += list->size) > H.nWatches) goto invalid; }
+  if (offset != H.nWatches) goto invalid;
+  if ((S->watchStore = (int*) malloc (sizeof (int) * (H.nWatches + 1))) == NULL) { printf ("c OUT OF MEMORY\n"); goto fail; }
+  readInts (&in, S->watchStore, H.nWatches);
+  for (i = 0; i < H.nWatches; i += 2) {                            // Every pair has to point to a clause in the DB
+    int mem = S->watchStore[i+1];                                   // (with at least two literals)
+    if (!S->watchStore[i] || !validLiterals (&S->watchStore[i], 1, n) || mem < 0 || mem + 2 >= H.mem_used ||
+        !S->DB[mem] || !S->DB[mem+1]) goto invalid; }
+  for (i = -n, offset = 0; i <= n; i++) {                           // Point the lists into the store
+    if (S->watches[i].size) S->watches[i].data = S->watchStore + offset, offset += S->watches[i].size;
+    if (S->implications[i].size) S->implications[i].data = S->watchStore + offset, offset += S->implications[i].size; }
+  if ((H.nAssignments && !(S->assignments = allocate (H.nAssignments))) || (H.nDead && !(S->dead = allocate (H.nDead))) ||
+      (H.nRepr && !(S->repr = allocate (H.nRepr))) || (H.nEliminated && !(S->eliminated.data = allocate (H.nEliminated))))
+    goto fail;                                                      // The message is already printed
+  readInts (&in, S->assignments, H.nAssignments); readInts (&in, S->dead, H.nDead);
+  readInts (&in, S->repr, H.nRepr); readInts (&in, S->eliminated.data, H.nEliminated);
+  if (!validLiterals (S->assignments, H.nAssignments, n) || !validLiterals (S->dead, H.nDead, n) ||
+      !validLiterals (S->repr, H.nRepr, n) || !validLiterals (S->eliminated.data, H.nEliminated, n)) goto invalid;
+  memset (S->buffer, 0, sizeof (int) * n);                          // Mark the variables that are not in the decision list:
+  for (i = 1; i < H.nRepr; i++) {                                   // the substituted ones
+    if (!S->repr[i]) goto invalid;
+    if (S->repr[i] != i) S->buffer[i-1] = 1; }
+  for (i = H.nEliminated; i > 0; i -= S->eliminated.data[i-1] + 1) { // and the eliminated ones: the eliminated clauses are
+    if (S->eliminated.data[i-1] < 1 || S->eliminated.data[i-1] >= i) goto invalid; // followed by their size
+    k = S->eliminated.data[i - 1 - S->eliminated.data[i-1]];        // and start with the pivot
+    if (!k) goto invalid;
+    S->buffer[abs (k) - 1] = 1; }
+  for (i = H.head; H.status == SAT && i; i = S->prev[i]) {          // The list has to contain every other variable once,
+    if (S->buffer[i-1] || S->next[S->prev[i]] != i) goto invalid;   // otherwise solve may never end (the list is not
+    S->buffer[i-1] = 2; }                                           // used after UNSAT, e.g. found while preprocessing)
+  for (i = 0; H.status == SAT && i < n; i++) if (!S->buffer[i]) goto invalid;
+  S->nAssignments = H.nAssignments; S->nDead = H.nDead; S->eliminated.size = S->eliminated.capacity = H.nEliminated;
+  S->mem_used = H.mem_used; S->mem_fixed = H.mem_fixed; S->nLemmas = H.nLemmas; S->maxLemmas = H.maxLemmas;
+  S->head = S->decision = H.head; S->fast = H.fast; S->slow = H.slow;
+  return S->status = H.status;
+
+  invalid: printf ("c INVALID SNAPSHOT\n");                         // Not written by this version of microsat
+  fail: if (initialized) freeSolver (S);                            // Release everything (nothing is usable)
+  free (S->assignments); free (S->dead); S->assignments = S->dead = NULL;
+  return ERROR; }
+
+int saveSnapshot (struct solver* S, char* filename) {              // Write a snapshot (with the lemmas) to a file
+  int* snapshot = writeSnapshot (S, 1);
+  if (snapshot == NULL) return ERROR;
+  FILE* file = fopen (filename, "wb");
+  size_t length = sizeof (int) * ((struct snapshot*) snapshot)->length;
+  int result = (file && fwrite (snapshot, 1, length, file) == length) ? OK : ERROR;
+  if (file && fclose (file)) result = ERROR;
+  if (result == ERROR) printf ("c CANNOT WRITE SNAPSHOT\n");
+  free (snapshot); return result; }
+
+void diversify (struct solver* S) {                               // Give every solver of a portfolio its own search
+  unsigned i, j, n = 0, seed = 2463534242u + S->id; int tmp, *order = S->buffer;
+  if (S->id == 0) return;                                          // Solver 0 is the default solver
+  S->margin = 110 + 10 * (S->id % 4);                              // Restart at 120%, 130%, 140% or 110% instead of 125%
+  for (tmp = S->head; tmp; tmp = S->prev[tmp]) order[n++] = tmp;   // Only the variables in the decision list: preprocessing
+  if (n == 0) return;                                              // unlinked the eliminated and substituted ones
+  for (i = n - 1; i > 0; i--) {                                    // Shuffle the variables (xorshift random numbers)
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    j = seed % (i + 1); tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    S->model[order[i]] = (S->id % 2) ? 1 : (seed >> 16) & 1; }     // Initial phases: all true or random
+  S->model[order[0]] = S->id % 2;
+  for (i = 1; i < n; i++) {                                        // Rebuild the decision order from the permutation
+    S->prev[order[i]] = order[i - 1]; S->next[order[i - 1]] = order[i]; }
+  S->prev[order[0]] = 0; S->next[0] = order[0];
+  S->head = order[n - 1]; S->next[S->head] = 0; }
 
+#ifndef __EMSCRIPTEN__
+struct worker { struct solver *S, solver; struct exchange* exchange; const int* snapshot; int id, conflicts; pthread_t thread; };
+
+void* solveWorker (void* arg) {                                    // Load the snapshot (unless done already) and solve in a thread
+  struct worker* W = (struct worker*) arg; struct solver* S = W->S; size_t length = W->snapshot ? sizeof (int) * ((struct snapshot*) W->snapshot)->length : 0;
+  int result = W->snapshot ? loadSnapshot (S, (const char*) W->snapshot, length) : SAT, expected = UNKNOWN, loaded = (result != ERROR);
+  if (result == SAT) {
+    S->exchange = W->exchange; S->id = W->id; S->nAssignments = 0;
+    S->nImported = (int*) calloc (W->exchange->nSolvers, sizeof (int));
+    if (S->nImported == NULL) printf ("c OUT OF MEMORY\n"), result = ERROR;
+    else diversify (S), S->decision = S->head, result = solveStep (S, W->conflicts, -1); }
+  if (result != UNKNOWN)                                           // The first answer cancels the other solvers
+    atomic_compare_exchange_strong (&W->exchange->result, &expected, result);
+  if (!loaded) return NULL;                                        // loadSnapshot released the memory already
+  free (S->nImported); S->nImported = NULL; S->exchange = NULL;
+  if (W->snapshot) free (S->assignments), free (S->dead), freeSolver (S); // Solver 0 belongs to the caller
+  return NULL; }
+
+int solvePortfolio (struct solver* S, int nSolvers, int conflicts) { // Solve with nSolvers threads (each within the budget)
+  struct exchange X; int i, result = ERROR;
+  struct worker* workers = (struct worker*) calloc (nSolvers, sizeof (struct worker));
+  int* snapshot = NULL;
+  atomic_init (&X.result, UNKNOWN); X.nSolvers = nSolvers;
+  X.nExported = (atomic_uint*) calloc (nSolvers, sizeof (atomic_uint));
+  X.slots = (struct slot*) calloc ((size_t) nSolvers * SHARE_SLOTS, sizeof (struct slot));
+  if (!workers || !X.nExported || !X.slots) printf ("c OUT OF MEMORY\n");
+  else if ((snapshot = writeSnapshot (S, 0)) != NULL) {            // The other solvers copy S instead of parsing again
+    for (i = 0; i < nSolvers; i++) {                               // Solver 0 reuses S, the others load the snapshot
+      workers[i].exchange = &X; workers[i].id = i; workers[i].conflicts = conflicts;
+      workers[i].S = i ? &workers[i].solver : S;
+      if (i) workers[i].snapshot = snapshot;                       // The same (preprocessed) formula as S
+      if (pthread_create (&workers[i].thread, NULL, solveWorker, &workers[i])) break; }
+    if (i == 0) solveWorker (&workers[0]);                         // Without threads, solve with solver 0 only
+    while (i--) pthread_join (workers[i].thread, NULL);
+    result = atomic_load (&X.result); }
+  free (workers); free (X.nExported); free (X.slots); free (snapshot);
+  return result; }
+#else
+int solvePortfolio (struct solver* S, int nSolvers, int conflicts) { // No threads in WebAssembly
+  S->decision = S->head; return solveStep (S, conflicts, -1); }
+#endif
+
+void setInput (const char* data, size_t size) {                    // Let main read the formula from memory
+  INPUT = data; INPUT_SIZE = size; }
+
+#ifdef __EMSCRIPTEN__
+size_t heapEnd () {                                                // End of the used linear memory: the Wrapper only
+  return (size_t) sbrk (0); }                                      // resets the memory below it after a run
+#endif
+
+void sessionFree (struct solver* S) {                              // Release the memory of a session
+  freeSolver (S); free (S->assignments); free (S->dead); free (S); }
+
+int sessionStart (struct solver* S) {                             // Prepare a parsed or loaded solver for queries
+  if (S->eliminated.size) { printf ("c SNAPSHOT ONLY FOR SOLVING\n"); S->status = ERROR; } // BVE changed the solutions
+  free (S->assignments); S->assignments = allocate (S->nVars);     // Buffer for the assumptions of a query
+  if (S->assignments == NULL) S->status = ERROR;
+  S->nAssignments = 0;
+  if (S->status == SAT && propagate (S) == UNSAT)                  // Propagate the top-level units once
+    S->status = UNSAT;                                             // and remember a root level conflict
+  return S->status; }
+
+struct solver* sessionCreate (const char* data, size_t size, int simplify) { // Parse the formula once and keep the solver alive
+  struct solver* S = (struct solver*) malloc (sizeof (struct solver));
+  if (S == NULL) return NULL;
+  S->status = parseBuffer (S, data, size, simplify ? SIMPLIFY_EQUIVALENT : SIMPLIFY_NONE); // A conflicting unit makes every query UNSAT
+  if (S->status == ERROR) { free (S); return NULL; }               // The message is already printed
+  if (sessionStart (S) == ERROR) { sessionFree (S); return NULL; }
+  return S; }
+
+struct solver* sessionLoad (const char* data, size_t size) {       // Same as sessionCreate, from a snapshot
+  struct solver* S = (struct solver*) malloc (sizeof (struct solver));
+  if (S == NULL) return NULL;
+  if (loadSnapshot (S, data, size) == ERROR) { free (S); return NULL; } // The message is already printed
+  if (sessionStart (S) == ERROR) { sessionFree (S); return NULL; }
+  return S; }
+
+int* sessionSnapshot (struct solver* S, int lemmas) {              // A snapshot of the session (between queries), or NULL
+  if (S->status == ERROR) return NULL;                             // The caller frees it, its length is in the header
+  return writeSnapshot (S, lemmas); }
+
+int sessionAssume (struct solver* S, int* assumptions, int n) {   // Copy the assumptions of a query into the solver
+  if (S->status == ERROR) return ERROR;                            // Out of memory in an earlier query
+  if (n > S->nVars) { printf ("c INVALID ASSUMPTIONS\n"); return ERROR; }
+  int i; for (i = 0; i < n; i++) {
+    if (!assumptions[i] || abs (assumptions[i]) > S->nVars) { printf ("c INVALID ASSUMPTIONS\n"); return ERROR; }
+    S->assignments[i] = representative (S, assumptions[i]); }
+  S->nAssignments = n;
+  return OK; }
+
+void resetModel (struct solver* S) {                               // Set the model to the current (root level) assignment
+  int i; for (i = 1; i <= S->nVars; i++) S->model[i] = (S->false[-i] != 0); }
+
+int sessionPropagate (struct solver* S, int* assumptions, int n) {  // Same as --propagate, without parsing the formula
+  if (S->status == UNSAT) return printf ("s UNSATISFIABLE\n"), UNSAT;
+  if (sessionAssume (S, assumptions, n) == ERROR) return ERROR;
+  int *root = S->forced, result;                                   // Remember the root level trail
+  resetModel (S);                                                  // Propagate as if the formula was just parsed
+  int consistent = evaluateDecisions (S); printDecisions (S, assumptions, n);     // A conflicting assignment is never buildable
+  int buildable = consistent && evaluateBuildability (S);
+  if (S->status == ERROR) return ERROR;                            // Out of memory: the session is not usable anymore
+  if (buildable) printf ("s BUILDABLE\n"), result = BUILDABLE;
+  else printf ("s INCOMPLETE\n"), result = INCOMPLETE;
+  backtrack (S, root); S->nAssignments = 0;                        // Undo the query, keep the clauses
+  resetModel (S);                                                  // Also for assumptions that conflicted with the root level
+  return result; }
+
+int sessionSolveStart (struct solver* S, int* assumptions, int n) { // Start to solve under assumptions (see sessionSolveStep)
+  if (S->status == UNSAT) return printf ("s UNSATISFIABLE\n"), UNSAT;
+  if (sessionAssume (S, assumptions, n) == ERROR) return ERROR;
+  S->decision = S->head; return UNKNOWN; }                         // The search starts at the head of the decision list
+
+int sessionSolveStep (struct solver* S, int conflicts, int propagations) { // Continue the solve within the budget (negative: no
+  int i, result = solveStep (S, conflicts, propagations);          // limit), UNKNOWN means that it is not done yet
+  if (result == UNKNOWN) return UNKNOWN;                           // Nothing is printed until the answer is found
+  if (result == ERROR) return ERROR;                               // Out of memory: the session is not usable anymore
+  if (result == SAT) { printf ("s SATISFIABLE\nv");                // Print the model of the variables
+    for (i = 1; i <= S->nVars; i++) printf (" %i", S->model[i] ? i : -i);
+    printf ("\n"); }
+  else printf ("s UNSATISFIABLE\n");
+  if (S->status != UNSAT) restart (S);                             // Return to the root level trail
+  S->nAssignments = 0;
+  return result; }
+
+void sessionSolveAbort (struct solver* S) {                        // Give up a solve that is not done (the lemmas are kept)
+  if (S->status != UNSAT) restart (S);
+  S->nAssignments = 0; }
+
+int sessionSolve (struct solver* S, int* assumptions, int n) {      // Solve under assumptions, keeping learned lemmas
+  int result = sessionSolveStart (S, assumptions, n);
+  return (result == UNKNOWN) ? sessionSolveStep (S, -1, -1) : result; }
+
+double sessionProgress (struct solver* S, int counter) {           // A counter for progress reports (see PROGRESS)
+  return (counter == PROGRESS_CONFLICTS) ? S->nConflicts : (counter == PROGRESS_PROPAGATIONS) ? S->nPropagations :
+         (counter == PROGRESS_LEMMAS) ? S->nLemmas : S->forced - S->falseStack; }
+
+int sessionBackbone (struct solver* S, int* assumptions, int n) {  // Same as --backbone, under the given assumptions
+  if (S->status == UNSAT) return printf ("s UNSATISFIABLE\n"), UNSAT;
+  if (sessionAssume (S, assumptions, n) == ERROR) return ERROR;
+  int* candidate = allocate (S->nVars + 1), result = ERROR;
+  if (candidate == NULL || (result = backbone (S, candidate)) == ERROR) { free (candidate); return S->status = ERROR; }
+  if (result == SAT) printBackbone (S, candidate), printf ("s SATISFIABLE\n");
+  else printf ("s UNSATISFIABLE\n");
+  if (S->status != UNSAT) restart (S);                             // Return to the root level trail
+  S->nAssignments = 0; free (candidate);
+  return result; }
+
+
+#ifndef NO_MAIN                                                                                             // Programs that include microsat.c (like the benchmark) define NO_MAIN
 int main (int argc, char** argv) {                                                                          // The main procedure
-  if (argc == 1) printf ("Usage: microsat [--version] [--propagate] DIMACS_FILE\n"), exit (OK);             // Print usage if no argument is given
-  if (!strcmp (argv[1], "--version")) printf (VERSION "\n"), exit (OK);                                     // Print version if argument --version is given
-  else if (!strcmp (argv[1], "--propagate")) MODE = MODE_PROPAGATE, ++argv;                                 // Set mode to propagate an assignment
-
-  struct solver S;                                                                        // Create the solver datastructure
-  if (parse (&S, argv[1]) == UNSAT) printf("s UNSATISFIABLE\n"), exit (UNSAT);            // Parse the DIMACS file
-
-  if (MODE == MODE_SOLVE) {
-    if (solve (&S) == UNSAT) printf("s UNSATISFIABLE\n"), exit (UNSAT);                   // Solve without limit (number of conflicts)
-    else printf("s SATISFIABLE\n"), exit (SAT); }                                         // and print whether the formula has a solution
-  else if (MODE == MODE_PROPAGATE) {
-    evaluateDecisions (&S), printDecisions (&S);
-    if (evaluateBuildability(&S)) printf ("s BUILDABLE\n"), exit (BUILDABLE);
-    else printf ("s INCOMPLETE\n"), exit (INCOMPLETE); } }
\ No newline at end of file
+  int mode = MODE_SOLVE, nThreads = 1, stats = 0, simplify = 0, load = 0, maxConflicts = -1; char* save = NULL; // Set by the options below
+  if (argc == 1 && !INPUT) printf ("Usage: microsat [--version] [--stats] [--preprocess] [--max-conflicts N] [--load-snapshot] [--save-snapshot FILE] [--propagate | --backbone | --threads N] DIMACS_FILE\n"
+                                   "--preprocess can imply more literals, so --propagate may answer BUILDABLE instead of INCOMPLETE\n"), exit (OK); // Print usage if no argument is given
+  for (;; ++argv)
+    if (argv[1] && !strcmp (argv[1], "--stats")) stats = 1;                                                 // Print statistics (before the result)
+    else if (argv[1] && !strcmp (argv[1], "--preprocess")) simplify = 1;                                    // Simplify the formula before solving
+    else if (argv[1] && !strcmp (argv[1], "--max-conflicts") && argv[2]) maxConflicts = atoi (argv[2]), ++argv; // Give up (s UNKNOWN) after N conflicts
+    else if (argv[1] && !strcmp (argv[1], "--load-snapshot")) load = 1;                                     // The file is a snapshot instead of DIMACS
+    else if (argv[1] && !strcmp (argv[1], "--save-snapshot") && argv[2]) save = argv[2], ++argv;            // Write a snapshot of the solver at the end
+    else break;
+  if (argv[1] && !strcmp (argv[1], "--version")) printf (VERSION "\n"), exit (OK);                          // Print version if argument --version is given
+  else if (argv[1] && !strcmp (argv[1], "--propagate")) mode = MODE_PROPAGATE, ++argv;                      // Set mode to propagate an assignment
+  else if (argv[1] && (!strcmp (argv[1], "--backbone") || !strcmp (argv[1], "--analyze")))                  // Set mode to find the core and
+    mode = MODE_BACKBONE, ++argv;                                                                           // dead variables (under the assignment)
+  else if (argv[1] && !strcmp (argv[1], "--threads") && argv[2]) nThreads = atoi (argv[2]), argv += 2;      // Solve with a portfolio of N solvers
+
+  struct solver S; size_t length = INPUT_SIZE;                                            // Create the solver datastructure
+  const char* data = argv[1] ? mapFile (argv[1], &length) : INPUT;                        // Map the DIMACS file (or use the input in memory)
+  if (data == NULL) exit (ERROR);
+  STAT (double start = seconds ();)
+  if (simplify) simplify = (mode == MODE_SOLVE) ? SIMPLIFY_ALL : SIMPLIFY_EQUIVALENT;      // Queries need the same solutions
+  int result = load ? loadSnapshot (&S, data, length) : parseBuffer (&S, data, length, simplify); // Load the snapshot, or parse (and simplify)
+  if (result == ERROR) exit (ERROR);                                                      // The message is already printed
+  if (mode != MODE_SOLVE && S.eliminated.size) printf ("c SNAPSHOT ONLY FOR SOLVING\n"), exit (ERROR); // BVE changed the solutions
+  STAT (if (stats) startTiming (&S, start);)
+  if (result == UNSAT) {
+    if (save && saveSnapshot (&S, save) == ERROR) exit (ERROR);
+    if (stats) printStats (&S);
+    printf("s UNSATISFIABLE\n"), exit (UNSAT); }
+  int nInput = S.nAssignments;                                                            // Saved with the snapshot
+  if (mode == MODE_SOLVE) S.nAssignments = 0;                                             // The "c v" line is only used by --propagate
+
+  if (mode == MODE_SOLVE) {                                                               // Solve (within --max-conflicts conflicts)
+    S.decision = S.head;                                                                  // Start at the head of the decision list
+    result = (nThreads > 1) ? solvePortfolio (&S, nThreads, maxConflicts)                 // The other solvers start from a snapshot of S
+                            : solveStep (&S, maxConflicts, -1);
+    if (result == ERROR) exit (ERROR);
+    if (save) { if (result == UNSAT) S.status = UNSAT; else restart (&S);                 // Keep the lemmas and phases at the root level
+      S.nAssignments = nInput; if (saveSnapshot (&S, save) == ERROR) exit (ERROR); }
+    if (stats) printStats (&S);                                                           // Of solver 0 for a portfolio
+    if (result == UNSAT) printf("s UNSATISFIABLE\n"), exit (UNSAT);
+    else if (result == UNKNOWN) printf("s UNKNOWN\n"), exit (UNKNOWN);                    // The budget of --max-conflicts is used up
+    else printf("s SATISFIABLE\n"), exit (SAT); }                                        // and print whether the formula has a solution
+  else if (mode == MODE_PROPAGATE) {
+    if (save && saveSnapshot (&S, save) == ERROR) exit (ERROR);                           // Before the assignment is propagated
+    int consistent = evaluateDecisions (&S); printDecisions (&S, S.assignments, S.nAssignments);
+    int buildable = consistent && evaluateBuildability (&S);
+    if (S.status == ERROR) exit (ERROR);                                                  // Out of memory
+    if (stats) printStats (&S);
+    if (buildable) printf ("s BUILDABLE\n"), exit (BUILDABLE);
+    else printf ("s INCOMPLETE\n"), exit (INCOMPLETE); }
+  else if (mode == MODE_BACKBONE) {
+    if (sessionAssume (&S, S.assignments, S.nAssignments) == ERROR) exit (ERROR);        // Check the "c v" line
+    int* candidate = allocate (S.nVars + 1);
+    if (candidate == NULL || (result = backbone (&S, candidate)) == ERROR) exit (ERROR);  // One solver for all the checks
+    if (save) { if (S.status != UNSAT) restart (&S);                                      // The lemmas of all the checks are kept
+      S.nAssignments = nInput; if (saveSnapshot (&S, save) == ERROR) exit (ERROR); }
+    if (stats) printStats (&S);
+    if (result == UNSAT) printf("s UNSATISFIABLE\n"), exit (UNSAT);
+    else printBackbone (&S, candidate), printf("s SATISFIABLE\n"), exit (SAT); } }
+#endif
@@ -0,0 +1,41 @@
+// Check that the worker pool of Wrapper.js replaces crashed workers: run "node test/pool.js" (Node.js only, no WASM build needed).
+// The pool runs a stub module instead of microsat. Its first worker exits while it is idle, and the job "exit" ends its worker with process.exit().
+const fs = require("fs");
+const os = require("os");
+const path = require("path");
+const Wrapper = require("../../src_js/Wrapper.js");
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), "microsat-pool-"));
+const lock = path.join(dir, "crashed");
+const stub = path.join(dir, "stub.js");
+fs.writeFileSync(stub, `
+const fs = require("fs");
+try { fs.writeFileSync(${JSON.stringify(lock)}, "", { flag: "wx" }); setTimeout(() => process.exit(4), 100); } catch (error) {}
+module.exports = () => Promise.resolve({ run: input => input === "exit" ? process.exit(3) : "s SATISFIABLE\\n" });
+`);
+
+let fail = message => { console.log("FAIL " + message); process.exit(1); };
+setTimeout(() => fail("a job was never settled"), 10000);
+
+// The stub ignores the compiled module, so an empty one will do.
+Wrapper._compiledModule = new WebAssembly.Module(new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0]));
+
+Wrapper.createPool({ size: 2, modulePath: stub }).then(pool => {
+	return new Promise(resolve => setTimeout(resolve, 300)).then(() => {
+		let jobs = ["a", "exit", "b", "c", "d"].map(input => pool.run(input).then(output => output.trim(), reason => "rejected: " + reason));
+		return Promise.all(jobs);
+	}).then(results => {
+		let expected = ["s SATISFIABLE", "rejected: worker exited with code 3", "s SATISFIABLE", "s SATISFIABLE", "s SATISFIABLE"];
+		if (JSON.stringify(results) !== JSON.stringify(expected)) {
+			fail(JSON.stringify(results));
+		}
+		if (pool.pending() !== 0) {
+			fail(pool.pending() + " jobs pending");
+		}
+		return pool.close();
+	});
+}).then(() => {
+	fs.rmSync(dir, { recursive: true });
+	console.log("pool ok");
+	process.exit(0);
+}, reason => fail(String(reason)));
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Run the regression checks (make test). Every test/NAME.expected holds the options of one run of microsat
+# in its first line, followed by the expected output and exit code. The runs are done in the order of their
+# names, from the directory of microsat, so a snapshot saved by one run can be loaded by a later one.
+
+cd "$(dirname "$0")/.."
+fail=0
+for expected in test/*.expected
+do
+	output=$(./microsat $(head -n 1 $expected); echo "exit $?")
+	if [ "$output" != "$(tail -n +2 $expected)" ]
+	then
+		echo "FAIL $expected"
+		echo "$output"
+		fail=1
+	fi
+done
+rm -f test/saved-*.snapshot
+[ $fail = 0 ] && echo "All tests passed"
+exit $fail
@@ -0,0 +1,91 @@
+/**
+ * The script run by each worker of a pool created with Wrapper.createPool().
+ * It works as a worker_threads Worker (Node.js) as well as a Web Worker (browser).
+ * Every worker owns its memory and instantiates the compiled module it receives once for each job.
+ */
+
+/**
+ * The CommonJS module generated by emscripten.
+ */
+let MODULE = undefined;
+
+/**
+ * The compiled WASM module, compiled once by the Wrapper and shared by all workers.
+ */
+let compiledModule = undefined;
+
+/**
+ * The memory of this worker. It is reset after each job.
+ */
+let memory = undefined;
+
+/**
+ * Send a message to the Wrapper.
+ */
+let post = undefined;
+
+/**
+ * A callback function to let WASM get an instance of the compiled module.
+ * See https://emscripten.org/docs/api_reference/module.html#Module.instantiateWasm.
+ */
+function instantiateWasm (info, callback) {
+	WebAssembly.instantiate(compiledModule, info).then(instance => {
+		callback(instance);
+	}, error => {
+		post({ type: "error", reason: String(error) });
+	});
+	return {};
+}
+
+/**
+ * Handle a message of the Wrapper.
+ * "init" loads the emscripten module, "run" runs one job and answers with its result.
+ */
+function onMessage (message) {
+	if (message.type === "init") {
+		if (typeof importScripts === "function") {
+			importScripts(message.modulePath);
+			MODULE = self[message.exportName];
+		}
+		else {
+			MODULE = require(message.modulePath);
+		}
+		compiledModule = message.compiledModule;
+		memory = new WebAssembly.Memory({ initial: message.pages });
+		post({ type: "ready" });
+	}
+	else if (message.type === "run") {
+		MODULE({
+			instantiateWasm: instantiateWasm,
+			"asm.js": false,
+			"wasmMemory": memory
+		}).then(instance => {
+			let result;
+			try {
+				result = instance.run(message.input, message.args);
+			}
+			catch (error) {
+				post({ type: "error", reason: String(error) });
+				return;
+			}
+			finally {
+				// reset the used part of the memory for the next job.
+				new Uint8Array(memory.buffer, 0, instance.heapEnd || memory.buffer.byteLength).fill(0);
+			}
+			post({ type: "result", result: result });
+		}, error => {
+			// the module could not be instantiated, the job fails but the worker stays usable.
+			post({ type: "error", reason: String(error) });
+		});
+	}
+}
+
+if (typeof importScripts === "function") {
+	post = message => self.postMessage(message);
+	self.onmessage = event => onMessage(event.data);
+}
+else {
+	const { parentPort } = require("worker_threads");
+	post = message => parentPort.postMessage(message);
+	parentPort.on("message", onMessage);
+}
@@ -105,7 +105,7 @@ Wrapper._WASM_INITIALIZER = function (info, callback) {
 /**
  * Run the wrapped module.
  * init() gets called before if needed.
- * @param {string} input - The content of the input file
+ * @param {string|Uint8Array} input - The content of the input file (a snapshot with "--load-snapshot")
  * @param {string[]} args - Additional command line arguments
  * @returns {Promise}
  */
@@ -135,8 +135,8 @@ Wrapper.run = function (input, args) {
 				"wasmMemory": Wrapper._memory
 			}).then(instance => {
 				let result = instance.run(input, args);
-				// reset the memory for the next run.
-				new Uint32Array(Wrapper._memory.buffer).fill(0);
+				// reset the used part of the memory for the next run.
+				new Uint8Array(Wrapper._memory.buffer, 0, instance.heapEnd || Wrapper._memory.buffer.byteLength).fill(0);
 
 				Wrapper._locked = false;
 				resolve(result);
@@ -147,4 +147,378 @@ Wrapper.run = function (input, args) {
 	return result;
 };
 
+/**
+ * Run the wrapped module with "--stats" (the module has to be built with statistics: microsat-stats.js and microsat-stats.wasm, see build.sh).
+ * init() gets called before if needed.
+ * @param {string} input - The content of the input file
+ * @param {string[]} args - Additional command line arguments
+ * @returns {Promise} - Resolves to an object { output, stats }: the textual result and the parsed statistics
+ */
+Wrapper.runWithStats = function (input, args = []) {
+	return Wrapper.run(input, ["--stats"].concat(args)).then(output => {
+		return { output: output, stats: Wrapper.parseStats(output) };
+	});
+};
+
+/**
+ * Parse the "c stats" lines printed by microsat with "--stats" (e.g. the output of a pool job).
+ * Returns an object with a number for each statistic, e.g. { decisions: 12, time_propagate: 0.003 },
+ * and an array of numbers for "lbd" (the number of lemmas with LBD 1, 2, ..., 15 and 16 or more).
+ */
+Wrapper.parseStats = function (output) {
+	let stats = {};
+	output.split("\n").forEach(line => {
+		let words = line.trim().split(/\s+/);
+		if (words.length >= 4 && words[0] === "c" && words[1] === "stats") {
+			let values = words.slice(3).map(Number);
+			stats[words[2]] = words[2] === "lbd" ? values : values[0];
+		}
+	});
+	return stats;
+};
+
+/**
+ * Create a session which parses the input once and answers many queries.
+ * Each session runs in its own instance with its own memory, so sessions do not block run().
+ * init() gets called before if needed.
+ * @param {string|Uint8Array} input - The content of the input file, or a snapshot (see snapshot()) which is loaded without parsing
+ * @param {Object} options - Optional, { preprocess: true } simplifies the formula once (as "--preprocess")
+ * @returns {Promise} - Resolves to an object with the following functions:
+ *  propagate(literals) - Same as run() with "--propagate" and "c v" set to the literals
+ *  solve(literals, options) - Solve under the literals as assumptions, learned clauses are kept.
+ *   The solver runs in steps and yields to the event loop between them. All options are optional:
+ *   timeout - Give up after this many milliseconds (resolves to "s UNKNOWN"), deadline - The same as a time (Date.now())
+ *   signal - An AbortSignal, the promise rejects once it is aborted
+ *   onProgress - Called after each step with { conflicts, propagations, lemmas, fixed } (counted since the session started)
+ *   conflictsPerStep, propagationsPerStep - The budget of a step (default: 1000 conflicts or 1000000 propagations)
+ *   Other queries reject while a solve is running.
+ *  backbone(literals) - Same as run() with "--backbone" and "c v" set to the literals
+ *  snapshot(options) - Resolves to a Uint8Array with the state of the session (phases, decision order and,
+ *   unless options.lemmas is false, the learned clauses), for createSession() or run() with "--load-snapshot"
+ *  close() - Release the session
+ */
+Wrapper.createSession = function (input, options = {}) {
+	let result = Promise.resolve();
+
+	// Call init() if needed
+	if (!(Wrapper._compiledModule && Wrapper._memory)) {
+		result = result.then(() => {
+			return Wrapper.init();
+		});
+	}
+
+	return result.then(_ => {
+		return new Promise((resolve, reject) => {
+			Wrapper._MODULE({
+				instantiateWasm: Wrapper._WASM_INITIALIZER,
+				"asm.js": false,
+				"wasmMemory": new WebAssembly.Memory({ initial: INITIAL_MEMORY_PAGES })
+			}).then(instance => {
+				let session;
+				try {
+					session = instance.createSession(input, options);
+				}
+				catch (error) {
+					reject(error.message);
+					return;
+				}
+
+				// A query runs at a time: a solve in steps keeps the session busy until it is done.
+				let solving = false;
+
+				let call = function (query) {
+					if (!session) {
+						return Promise.reject("The session is closed");
+					}
+					if (solving) {
+						return Promise.reject("The session is busy");
+					}
+					try {
+						return Promise.resolve(query());
+					}
+					catch (error) {
+						return Promise.reject(error.message);
+					}
+				};
+
+				// Solve in steps, so the event loop runs between them.
+				let solve = function (literals, options, resolve, reject) {
+					let deadline = options.deadline !== undefined ? options.deadline : Date.now() + (options.timeout !== undefined ? options.timeout : Infinity);
+					let conflicts = options.conflictsPerStep || 1000;
+					let propagations = options.propagationsPerStep || 1000000;
+
+					let finish = function (settle, value) {
+						solving = false;
+						settle(value);
+					};
+
+					let step = function () {
+						if (!session) {
+							finish(reject, "The session is closed");
+						}
+						else if (options.signal && options.signal.aborted) {
+							session.solveAbort();
+							finish(reject, "The solve was aborted");
+						}
+						else if (Date.now() >= deadline) {
+							session.solveAbort();
+							finish(resolve, "s UNKNOWN\n");
+						}
+						else {
+							let output = session.solveStep(conflicts, propagations);
+							if (output !== undefined) {
+								finish(resolve, output);
+							}
+							else {
+								if (options.onProgress) {
+									options.onProgress(session.progress());
+								}
+								Wrapper._yield(step);
+							}
+						}
+					};
+
+					let output = session.solveStart(literals);
+					if (output !== undefined) {
+						resolve(output);
+					}
+					else {
+						solving = true;
+						step();
+					}
+				};
+
+				resolve({
+					propagate: literals => {
+						return call(() => session.propagate(literals));
+					},
+					solve: (literals, options = {}) => {
+						return call(() => new Promise((resolve, reject) => solve(literals, options, resolve, reject)));
+					},
+					backbone: literals => {
+						return call(() => session.backbone(literals));
+					},
+					snapshot: (options = {}) => {
+						return call(() => session.snapshot(options.lemmas !== false));
+					},
+					close: () => {
+						if (session) {
+							if (solving) {
+								session.solveAbort();
+							}
+							session.free();
+							session = undefined;
+						}
+						return Promise.resolve();
+					}
+				});
+			});
+		});
+	});
+};
+
+/**
+ * Call the function after the pending events (e.g. the UI or the messages of a worker) are handled.
+ */
+Wrapper._yield = typeof setImmediate === "function" ? setImmediate : callback => setTimeout(callback, 0);
+
+/**
+ * Parse the input once and return its snapshot, which createSession() and run() with "--load-snapshot" load without parsing.
+ * Snapshots are files of 32-bit integers, so the native build (on little-endian machines) reads them as well.
+ * @param {string} input - The content of the input file
+ * @param {Object} options - Optional, { preprocess: true } simplifies the formula first (as for createSession())
+ * @returns {Promise} - Resolves to a Uint8Array
+ */
+Wrapper.createSnapshot = function (input, options = {}) {
+	return Wrapper.createSession(input, options).then(session => {
+		return session.snapshot().then(snapshot => {
+			return session.close().then(() => snapshot);
+		}, reason => {
+			return session.close().then(() => Promise.reject(reason));
+		});
+	});
+};
+
+/**
+ * Create a worker for a pool: a worker_threads Worker in Node.js and a Web Worker in browsers.
+ * Returns an object with the functions post(message), listen(onMessage, onError) and terminate().
+ */
+Wrapper._createWorker = function (path) {
+	if (typeof Worker === "undefined") {
+		// module.require is not picked up by browserify
+		const { Worker } = module.require("worker_threads");
+		let worker = new Worker(path);
+		let terminated = false;
+		return {
+			post: message => worker.postMessage(message),
+			listen: (onMessage, onError) => {
+				worker.on("message", onMessage);
+				worker.on("error", onError);
+				// process.exit() in the worker (e.g. an abort of the module) only emits "exit".
+				worker.on("exit", code => {
+					if (!terminated) {
+						onError("worker exited with code " + code);
+					}
+				});
+			},
+			terminate: () => {
+				terminated = true;
+				worker.terminate();
+			}
+		};
+	}
+	else {
+		let worker = new Worker(path);
+		return {
+			post: message => worker.postMessage(message),
+			listen: (onMessage, onError) => {
+				worker.onmessage = event => onMessage(event.data);
+				worker.onerror = event => onError(event.message);
+			},
+			terminate: () => worker.terminate()
+		};
+	}
+};
+
+/**
+ * Create a pool of workers which run jobs like run(), but concurrently.
+ * The WASM file is compiled once and shared by all workers, each worker instantiates it with its own memory.
+ * Jobs are started in the order of the calls to run().
+ * init() gets called before if needed.
+ * @param {Object} options
+ *  size - The number of workers (default: the number of cores)
+ *  maxQueued - run() rejects once this many jobs are waiting for a worker (default: 16 per worker)
+ *  modulePath - The path (Node.js) or URL (browser) of microsat.js (default in Node.js: next to Wrapper.js)
+ *  workerPath - The path (Node.js) or URL (browser) of PoolWorker.js (default in Node.js: next to Wrapper.js)
+ *  exportName - The EXPORT_NAME used to build microsat.js (default: "microsat")
+ * @returns {Promise} - Resolves to an object with the following functions:
+ *  run(input, args) - Same as Wrapper.run(), resolves once a worker finished the job
+ *  pending() - The number of jobs that are waiting or running
+ *  close() - Reject the waiting jobs and terminate the workers once the running jobs are done
+ */
+Wrapper.createPool = function (options = {}) {
+	let isNode = typeof Worker === "undefined";
+	let size = options.size || (isNode ? module.require("os").cpus().length : navigator.hardwareConcurrency) || 1;
+	let maxQueued = options.maxQueued || 16 * size;
+	let modulePath = options.modulePath || (isNode ? __dirname + "/microsat.js" : undefined);
+	let workerPath = options.workerPath || (isNode ? __dirname + "/PoolWorker.js" : undefined);
+
+	if (!(modulePath && workerPath)) {
+		return Promise.reject("Please set the modulePath and the workerPath of the pool.");
+	}
+
+	let result = Promise.resolve();
+
+	// Call init() if needed
+	if (!Wrapper._compiledModule) {
+		result = result.then(() => {
+			return Wrapper.init();
+		});
+	}
+
+	return result.then(_ => {
+		let queue = [];
+		let idle = [];
+		let closed = false;
+		let running = 0;
+
+		// Start the waiting jobs on the idle workers (first in, first out).
+		let dispatch = function () {
+			while (idle.length > 0 && queue.length > 0) {
+				let worker = idle.shift();
+				worker.job = queue.shift();
+				running++;
+				worker.post({ type: "run", input: worker.job.input, args: worker.job.args });
+			}
+		};
+
+		// A worker finished its job (or crashed), so it can take the next one.
+		let finish = function (worker, settle) {
+			let job = worker.job;
+			worker.job = undefined;
+			running--;
+			settle(job);
+			if (closed) {
+				worker.terminate();
+			}
+			else {
+				idle.push(worker);
+				dispatch();
+			}
+		};
+
+		let start = function () {
+			let worker = Wrapper._createWorker(workerPath);
+			worker.listen(message => {
+				if (message.type === "ready") {
+					if (closed) {
+						worker.terminate();
+					}
+					else {
+						idle.push(worker);
+						dispatch();
+					}
+				}
+				else if (message.type === "result") {
+					finish(worker, job => job.resolve(message.result));
+				}
+				else if (message.type === "error") {
+					finish(worker, job => job.reject(message.reason));
+				}
+			}, error => {
+				// Replace a crashed worker (which may be waiting for a job), once: "error" is followed by "exit".
+				if (worker.crashed) {
+					return;
+				}
+				worker.crashed = true;
+				worker.terminate();
+				let index = idle.indexOf(worker);
+				if (index >= 0) {
+					idle.splice(index, 1);
+				}
+				if (worker.job) {
+					running--;
+					worker.job.reject(String(error));
+				}
+				if (!closed) {
+					start();
+				}
+			});
+			worker.post({
+				type: "init",
+				modulePath: modulePath,
+				exportName: options.exportName || "microsat",
+				compiledModule: Wrapper._compiledModule,
+				pages: INITIAL_MEMORY_PAGES
+			});
+		};
+
+		for (let i = 0; i < size; i++) {
+			start();
+		}
+
+		return {
+			run: (input, args = []) => {
+				if (closed) {
+					return Promise.reject("The pool is closed");
+				}
+				if (queue.length >= maxQueued) {
+					return Promise.reject("The queue of the pool is full");
+				}
+				return new Promise((resolve, reject) => {
+					queue.push({ input: input, args: Array.from(args), resolve: resolve, reject: reject });
+					dispatch();
+				});
+			},
+			pending: () => queue.length + running,
+			close: () => {
+				closed = true;
+				queue.splice(0).forEach(job => job.reject("The pool is closed"));
+				idle.splice(0).forEach(worker => worker.terminate());
+				return Promise.resolve();
+			}
+		};
+	});
+};
+
 module.exports = Wrapper;
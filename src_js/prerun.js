@@ -7,6 +7,7 @@
 Module.preRun = Module.preRun || [];
 Module.preRun.push(addMyStdOut);
 Module.preRun.push(addRun);
+Module.preRun.push(addSession);
 
 /**
  * Add the MyStdout object to the module.
@@ -51,29 +52,156 @@ function addMyStdOut () {
 	);
 }
 
+/**
+ * Copy the input straight into the linear memory, so microsat can read it without a file.
+ * A string (DIMACS) is copied as UTF-8, a Uint8Array or an ArrayBuffer (a snapshot) as is.
+ * Returns the pointer and the length in bytes, the caller has to free the pointer.
+ */
+function writeInput (input) {
+	if (typeof input !== "string") {
+		let bytes = new Uint8Array(input);
+		let pointer = _malloc(Math.max(bytes.length, 1));
+		HEAPU8.set(bytes, pointer);
+		return { pointer: pointer, length: bytes.length };
+	}
+	let length = lengthBytesUTF8(input);
+	let pointer = _malloc(length + 1);
+	stringToUTF8(input, pointer, length + 1);
+	return { pointer: pointer, length: length };
+}
+
 /**
  * Add a function that wraps the main call.
  */
 function addRun () {
 	/**
 	 * Call main.
-	 * input is the content of the input file.
+	 * input is the content of the input file (a snapshot with "--load-snapshot").
 	 * args can be used to pass additional command line arguments
 	 */
 	Module.run = function (input = "", args = []) {
 		Module.MyStdout.clear();
 
-		FS.writeFile("input", input);
+		// main reads the input from memory, as no file name is passed.
+		// The input is not freed: the runtime exits with main and the memory is reset by the Wrapper.
+		let data = writeInput(input);
+		ccall("setInput", null, ["number", "number"], [data.pointer, data.length]);
 
-		let callArgs = Array.from(args);
-		callArgs.push("/input");
+		callMain(Array.from(args));
 
-		callMain(callArgs);
+		// The end of the used memory, so the Wrapper does not have to reset all of it.
+		try {
+			Module.heapEnd = _heapEnd();
+		}
+		catch (error) {
+			Module.heapEnd = undefined;
+		}
 
 		Module.MyStdout.flush();
 
-		FS.unlink("input");
-
 		return Module.MyStdout.getContents();
 	}
 }
+
+/**
+ * Add a function that creates a solver session.
+ */
+function addSession () {
+	/**
+	 * Parse the formula once and keep the solver alive for many queries.
+	 * input is the content of the input file, options.preprocess simplifies the formula first.
+	 * If input is a Uint8Array or an ArrayBuffer, it is a snapshot (see snapshot()) and is loaded instead.
+	 * Each query takes an array of literals (assumptions) and returns the output of microsat.
+	 */
+	Module.createSession = function (input = "", options = {}) {
+		Module.MyStdout.clear();
+
+		let data = writeInput(input);
+
+		let solver = typeof input === "string"
+			? ccall("sessionCreate", "number", ["number", "number", "number"], [data.pointer, data.length, options.preprocess ? 1 : 0])
+			: ccall("sessionLoad", "number", ["number", "number"], [data.pointer, data.length]);
+
+		_free(data.pointer);
+
+		// sessionCreate and sessionLoad return 0 if the input is malformed or memory runs out (the reason is printed).
+		if (!solver) {
+			Module.MyStdout.flush();
+			throw new Error(Module.MyStdout.getContents().trim() || "Could not create the session");
+		}
+
+		let query = function (name, literals = []) {
+			Module.MyStdout.clear();
+
+			let buffer = _malloc(4 * Math.max(literals.length, 1));
+			HEAP32.set(literals, buffer >> 2);
+
+			ccall(name, "number", ["number", "number", "number"], [solver, buffer, literals.length]);
+
+			_free(buffer);
+
+			Module.MyStdout.flush();
+
+			return Module.MyStdout.getContents();
+		};
+
+		// Copy the solver (and the learned clauses if lemmas is true) out of the linear memory.
+		// The length in bytes is 4 times the third integer of the header.
+		let snapshot = function (lemmas) {
+			let pointer = ccall("sessionSnapshot", "number", ["number", "number"], [solver, lemmas ? 1 : 0]);
+			if (!pointer) {
+				throw new Error("Could not create the snapshot");
+			}
+			let bytes = HEAPU8.slice(pointer, pointer + 4 * HEAP32[(pointer >> 2) + 2]);
+			_free(pointer);
+			return bytes;
+		};
+
+		// Solve in steps: solveStart(literals) and solveStep(conflicts, propagations) return undefined
+		// while the solve is not done (the budget is used up) and the output of microsat once it is.
+		let solveStart = function (literals = []) {
+			Module.MyStdout.clear();
+
+			let buffer = _malloc(4 * Math.max(literals.length, 1));
+			HEAP32.set(literals, buffer >> 2);
+
+			let result = ccall("sessionSolveStart", "number", ["number", "number", "number"], [solver, buffer, literals.length]);
+
+			_free(buffer);
+
+			return result === 0 ? undefined : output();
+		};
+
+		let solveStep = function (conflicts = -1, propagations = -1) {
+			let result = ccall("sessionSolveStep", "number", ["number", "number", "number"], [solver, conflicts, propagations]);
+			return result === 0 ? undefined : output();
+		};
+
+		let output = function () {
+			Module.MyStdout.flush();
+			return Module.MyStdout.getContents();
+		};
+
+		// The counters of the solver (see enum PROGRESS in microsat.c).
+		let progress = function () {
+			return {
+				conflicts: ccall("sessionProgress", "number", ["number", "number"], [solver, 0]),
+				propagations: ccall("sessionProgress", "number", ["number", "number"], [solver, 1]),
+				lemmas: ccall("sessionProgress", "number", ["number", "number"], [solver, 2]),
+				fixed: ccall("sessionProgress", "number", ["number", "number"], [solver, 3])
+			};
+		};
+
+		return {
+			propagate: literals => query("sessionPropagate", literals),
+			solve: literals => query("sessionSolve", literals),
+			solveStart: literals => solveStart(literals),
+			solveStep: (conflicts, propagations) => solveStep(conflicts, propagations),
+			solveAbort: () => ccall("sessionSolveAbort", null, ["number"], [solver]),
+			progress: () => progress(),
+			backbone: literals => query("sessionBackbone", literals),
+			snapshot: lemmas => snapshot(lemmas),
+			free: () => ccall("sessionFree", null, ["number"], [solver])
+		};
+	}
+}